@@ -841,6 +841,13 @@ void MainWindow::setupMenus() {
     connect(importTextureAction, &QAction::triggered, this, &MainWindow::importTexture);
     bulkExportAction = textureMenu->addAction("&Bulk export...");
     connect(bulkExportAction, &QAction::triggered, this, &MainWindow::bulkExport);
+    textureMenu->addSeparator();
+    autoFormatAction = textureMenu->addAction("Choose &formats automatically");
+    autoFormatAction->setCheckable(true);
+    autoFormatAction->setChecked(model->getAutoSelectFormats());
+    connect(autoFormatAction, &QAction::toggled, this, [this](bool checked) {
+        model->setAutoSelectFormats(checked);
+    });
     
     // Help menu
     QMenu* helpMenu = menuBar()->addMenu("&Help");
@@ -1151,7 +1158,13 @@ bool MainWindow::saveTXD(const QString& filepath) {
         return false;
     }
     
-    setStatusMessage("File saved successfully");
+    if (model->getAutoSelectFormats() && !model->getFormatReport().entries.empty()) {
+        const auto& report = model->getFormatReport();
+        setStatusMessage(QString("File saved successfully, automatic formats saved %1 KB")
+                             .arg(report.getBytesSaved() / 1024));
+    } else {
+        setStatusMessage("File saved successfully");
+    }
     return true;
 }
 
@@ -1531,17 +1544,9 @@ void MainWindow::exportTexture() {
         }
     } else if (exportType == AlphaOnly) {
         // Export alpha channel as grayscale
-        QImage alphaImage = rgbaImage.copy();
-        int width = alphaImage.width();
-        int height = alphaImage.height();
-        
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                QRgb pixel = alphaImage.pixel(x, y);
-                uint8_t alpha = qAlpha(pixel);
-                alphaImage.setPixel(x, y, qRgb(alpha, alpha, alpha));
-            }
-        }
+        std::vector<uint8_t> alphaPlane = entry->getAlpha();
+        QImage alphaImage = QImage(alphaPlane.data(), entry->width, entry->height,
+                                   entry->width, QImage::Format_Grayscale8).copy();
         
         QString suggestedName = baseName + "_alpha.png";
         QString filepath = QFileDialog::getSaveFileName(
@@ -1572,17 +1577,9 @@ void MainWindow::exportTexture() {
                 QFileInfo fileInfo(filepath);
                 QString alphaPath = fileInfo.path() + "/" + fileInfo.completeBaseName() + "_alpha." + fileInfo.suffix();
                 
-                QImage alphaImage = rgbaImage.copy();
-                int width = alphaImage.width();
-                int height = alphaImage.height();
-                
-                for (int y = 0; y < height; y++) {
-                    for (int x = 0; x < width; x++) {
-                        QRgb pixel = alphaImage.pixel(x, y);
-                        uint8_t alpha = qAlpha(pixel);
-                        alphaImage.setPixel(x, y, qRgb(alpha, alpha, alpha));
-                    }
-                }
+                std::vector<uint8_t> alphaPlane = entry->getAlpha();
+                QImage alphaImage = QImage(alphaPlane.data(), entry->width, entry->height,
+                                           entry->width, QImage::Format_Grayscale8).copy();
                 
                 if (alphaImage.save(alphaPath)) {
                     setStatusMessage(QString("Exported diffuse and alpha: %1, %2").arg(filepath, alphaPath));
@@ -1768,17 +1765,9 @@ void MainWindow::bulkExport() {
         // Export alpha if texture has alpha channel
         bool hasAlpha = entry->hasAlpha;
         if (hasAlpha) {
-            QImage alphaImage = rgbaImage.copy();
-            int width = alphaImage.width();
-            int height = alphaImage.height();
-            
-            for (int y = 0; y < height; y++) {
-                for (int x = 0; x < width; x++) {
-                    QRgb pixel = alphaImage.pixel(x, y);
-                    uint8_t alpha = qAlpha(pixel);
-                    alphaImage.setPixel(x, y, qRgb(alpha, alpha, alpha));
-                }
-            }
+            std::vector<uint8_t> alphaPlane = entry->getAlpha();
+            QImage alphaImage = QImage(alphaPlane.data(), entry->width, entry->height,
+                                       entry->width, QImage::Format_Grayscale8).copy();
             
             QString alphaPath = folderPath + baseName + "_alpha.png";
             if (alphaImage.save(alphaPath)) {
@@ -1900,8 +1889,14 @@ void MainWindow::onReplaceDiffuseRequested(int index) {
                     .arg(oldWidth).arg(oldHeight),
             QMessageBox::Yes | QMessageBox::No);
         if (ret == QMessageBox::Yes) {
-            rgbaImage = rgbaImage.scaled(oldWidth, oldHeight, 
-                                        Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            QImage resized(static_cast<int>(oldWidth), static_cast<int>(oldHeight), QImage::Format_RGBA8888);
+            if (!LibTXD::TextureConverter::resizeRGBA(rgbaImage.constBits(), rgbaImage.width(), rgbaImage.height(),
+                                                      resized.bits(), oldWidth, oldHeight,
+                                                      LibTXD::ResizeFilter::Lanczos3, true)) {
+                QMessageBox::critical(this, "Import Error", "Failed to resize image.");
+                return;
+            }
+            rgbaImage = resized;
         } else {
             return;
         }
@@ -1969,6 +1964,7 @@ void MainWindow::onReplaceDiffuseRequested(int index) {
     entry->diffuse = newTextureData;
     entry->width = newWidth;
     entry->height = newHeight;
+    entry->pixelsDirty = true;
     model->setModified(true);
     
     // Update UI
@@ -2032,46 +2028,27 @@ void MainWindow::onReplaceAlphaRequested(int index) {
         return;
     }
     
-    // Copy existing RGBA data
-    size_t dataSize = width * height * 4;
-    std::unique_ptr<uint8_t[]> existingRGBA = std::make_unique<uint8_t[]>(dataSize);
-    std::memcpy(existingRGBA.get(), entry->diffuse.data(), dataSize);
-    
-    // Prepare new texture data
-    std::vector<uint8_t> newTextureData(dataSize);
-    
+    // Preserve RGB, replace alpha from the new image: its own alpha where that
+    // is translucent, otherwise its grayscale value
+    const size_t pixelCount = static_cast<size_t>(width) * height;
     const uint8_t* imageData = rgbaImage.constBits();
-    
-    // Preserve RGB, replace alpha from the new image
-    // Use the grayscale value of the new image as alpha
-    for (int y = 0; y < static_cast<int>(height); y++) {
-        for (int x = 0; x < static_cast<int>(width); x++) {
-            size_t pixelIndex = (y * width + x) * 4;
-            
-            // Preserve RGB from existing texture
-            newTextureData[pixelIndex] = existingRGBA[pixelIndex];         // R
-            newTextureData[pixelIndex + 1] = existingRGBA[pixelIndex + 1]; // G
-            newTextureData[pixelIndex + 2] = existingRGBA[pixelIndex + 2]; // B
-            
-            // Use grayscale value from new image as alpha
-            QRgb pixel = rgbaImage.pixel(x, y);
-            uint8_t alpha = qAlpha(pixel);
-            if (alpha == 255 && rgbaImage.hasAlphaChannel()) {
-                // Image has alpha channel but this pixel is fully opaque, use grayscale
-                newTextureData[pixelIndex + 3] = qGray(pixel);
-            } else if (alpha < 255) {
-                // Use the alpha channel value
-                newTextureData[pixelIndex + 3] = alpha;
-            } else {
-                // No alpha channel, use grayscale
-                newTextureData[pixelIndex + 3] = qGray(pixel);
-            }
+    std::vector<uint8_t> alphaPlane(pixelCount);
+    std::vector<uint8_t> grayPlane(pixelCount);
+    LibTXD::TextureConverter::extractAlpha(imageData, pixelCount, alphaPlane.data());
+    LibTXD::TextureConverter::extractLuminance(imageData, pixelCount, grayPlane.data());
+    for (size_t i = 0; i < pixelCount; i++) {
+        if (alphaPlane[i] == 255) {
+            alphaPlane[i] = grayPlane[i];
         }
     }
     
+    std::vector<uint8_t> newTextureData = entry->diffuse;
+    LibTXD::TextureConverter::insertAlpha(newTextureData.data(), pixelCount, alphaPlane.data());
+    
     // Update entry data
     entry->diffuse = newTextureData;
     entry->hasAlpha = true;
+    entry->pixelsDirty = true;
     model->setModified(true);
     
     // Update UI
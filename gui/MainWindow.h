@@ -101,6 +101,7 @@ private:
     QAction* exportTextureAction = nullptr;
     QAction* importTextureAction = nullptr;
     QAction* bulkExportAction = nullptr;
+    QAction* autoFormatAction = nullptr;
     QAction* toolbarSeparator = nullptr;
 };
 
@@ -7,11 +7,126 @@
 #include <cstring>
 #include <algorithm>
 
+namespace {
+
+// Whether the originally loaded encoding still represents the entry exactly
+bool canReuseOriginal(const TXDFileEntry& entry) {
+    if (!entry.original || entry.pixelsDirty || entry.original->getMipmapCount() == 0) {
+        return false;
+    }
+    const LibTXD::Texture& original = *entry.original;
+    const auto& base = original.getMipmap(0);
+    // A palette texture whose format was changed keeps its base format but
+    // loses its PAL4/PAL8 bit, so those count as part of the format
+    const uint32_t formatMask = static_cast<uint32_t>(LibTXD::RasterFormat::MASK) |
+                                static_cast<uint32_t>(LibTXD::RasterFormat::PAL8) |
+                                static_cast<uint32_t>(LibTXD::RasterFormat::PAL4);
+    bool sameFormat = entry.compressionEnabled ||
+                      (static_cast<uint32_t>(original.getRasterFormat()) & formatMask) ==
+                      (static_cast<uint32_t>(entry.rasterFormat) & formatMask);
+    return base.width == entry.width && base.height == entry.height &&
+           original.hasAlpha() == entry.hasAlpha && sameFormat &&
+           original.getCompression() == entry.getSaveCompression();
+}
+
+// Raster format for an uncompressed save: the entry's 16-bit or LUM8 format if
+// it has one, otherwise 32 or 24-bit depending on alpha
+LibTXD::RasterFormat uncompressedFormat(const TXDFileEntry& entry) {
+    auto base = static_cast<LibTXD::RasterFormat>(
+        static_cast<uint32_t>(entry.rasterFormat) & static_cast<uint32_t>(LibTXD::RasterFormat::MASK));
+    switch (base) {
+        case LibTXD::RasterFormat::R5G6B5:
+        case LibTXD::RasterFormat::A1R5G5B5:
+        case LibTXD::RasterFormat::R4G4B4A4:
+        case LibTXD::RasterFormat::LUM8:
+            return base;
+        default:
+            return entry.hasAlpha ? LibTXD::RasterFormat::B8G8R8A8 : LibTXD::RasterFormat::B8G8R8;
+    }
+}
+
+// Format used when automatic selection is off: the entry's DXT format when
+// compression is enabled, otherwise uncompressedFormat
+LibTXD::FormatChoice defaultFormat(const TXDFileEntry& entry) {
+    LibTXD::FormatChoice choice;
+    if (entry.compressionEnabled) {
+        choice.compression = entry.getSaveCompression();
+        switch (choice.compression) {
+            case LibTXD::Compression::DXT1:
+                // Alpha below 128 becomes punch-through transparency
+                choice.name = entry.hasAlpha ? "DXT1a" : "DXT1";
+                break;
+            case LibTXD::Compression::DXT3:
+                choice.name = "DXT3";
+                break;
+            default:
+                choice.name = "DXT5";
+                break;
+        }
+        choice.rasterFormat = LibTXD::TextureConverter::getDXTRasterFormat(choice.compression, entry.hasAlpha);
+        choice.depth = 16;  // DXT uses 16-bit depth indicator
+        choice.bytes = LibTXD::TextureConverter::getCompressedDataSize(entry.width, entry.height, choice.compression);
+    } else {
+        choice.rasterFormat = uncompressedFormat(entry);
+        uint32_t pixelSize = LibTXD::TextureConverter::getUncompressedPixelSize(choice.rasterFormat);
+        choice.name = "uncompressed";
+        choice.depth = pixelSize * 8;
+        choice.bytes = static_cast<size_t>(entry.width) * entry.height * pixelSize;
+    }
+    return choice;
+}
+
+// Whether a selected format is the one the original is already stored in
+bool matchesOriginal(const LibTXD::FormatChoice& choice, const LibTXD::Texture& original) {
+    if (choice.compression != original.getCompression()) {
+        return false;
+    }
+    if (choice.compression != LibTXD::Compression::NONE) {
+        return true;
+    }
+    const uint32_t formatMask = static_cast<uint32_t>(LibTXD::RasterFormat::MASK) |
+                                static_cast<uint32_t>(LibTXD::RasterFormat::PAL8) |
+                                static_cast<uint32_t>(LibTXD::RasterFormat::PAL4);
+    return choice.paletteSize == original.getPaletteSize() &&
+           (static_cast<uint32_t>(choice.rasterFormat) & formatMask) ==
+           (static_cast<uint32_t>(original.getRasterFormat()) & formatMask);
+}
+
+// Level 0 bytes of the original encoding, plus its palette
+size_t originalBytes(const LibTXD::Texture& original) {
+    return original.getMipmap(0).dataSize + static_cast<size_t>(original.getPaletteSize()) * 4;
+}
+
+// Copy of the original encoding with the entry's editable metadata applied
+LibTXD::Texture copyOriginalTexture(const TXDFileEntry& entry) {
+    const LibTXD::Texture& original = *entry.original;
+    LibTXD::Texture texture;
+    texture.setName(entry.name.toStdString());
+    texture.setMaskName(entry.maskName.toStdString());
+    texture.setFilterFlags(entry.filterFlags);
+    texture.setPlatform(entry.platform);
+    texture.setRasterFormat(original.getRasterFormat());
+    texture.setCompression(original.getCompression());
+    texture.setDepth(original.getDepth());
+    texture.setHasAlpha(original.hasAlpha());
+    if (original.getPaletteSize() > 0) {
+        texture.setPalette(original.getPalette(), original.getPaletteSize());
+    }
+    for (uint32_t level = 0; level < original.getMipmapCount(); ++level) {
+        texture.addMipmap(original.getMipmap(level));
+    }
+    return texture;
+}
+
+} // namespace
+
 TXDModel::TXDModel(QObject* parent)
     : QObject(parent)
     , gameVersion(LibTXD::GameVersion::UNKNOWN)
     , version(0)
     , modified(false)
+    , ditherMode(LibTXD::DitherMode::ErrorDiffusion)
+    , autoSelectFormats(false)
 {
 }
 
@@ -20,7 +135,9 @@ TXDModel::~TXDModel() {
 }
 
 bool TXDModel::loadFromFile(const QString& filepath) {
+    // Loaded payloads share one slab; unchanged textures keep using it until saved
     auto dict = std::make_unique<LibTXD::TextureDictionary>();
+    dict->setArenaEnabled(true);
     if (!dict->load(filepath.toStdString())) {
         return false;
     }
@@ -156,6 +273,7 @@ bool TXDModel::loadFromDictionary(LibTXD::TextureDictionary* dict) {
         entry.maskName = QString::fromStdString(libTexture->getMaskName());
         entry.rasterFormat = libTexture->getRasterFormat();
         entry.compressionEnabled = (libTexture->getCompression() != LibTXD::Compression::NONE);
+        entry.compressionFormat = libTexture->getCompression();
         entry.width = mipmap.width;
         entry.height = mipmap.height;
         entry.hasAlpha = libTexture->hasAlpha();
@@ -196,6 +314,10 @@ bool TXDModel::loadFromDictionary(LibTXD::TextureDictionary* dict) {
             // Conversion failed, skip this texture
             continue;
         }
+        
+        // Keep the encoded data so unchanged textures are saved without recompression
+        // (the dictionary is discarded after loading, so it can be moved out)
+        entry.original = std::make_shared<LibTXD::Texture>(std::move(*dict->getTexture(i)));
 
         entries.push_back(std::move(entry));
     }
@@ -206,81 +328,224 @@ bool TXDModel::loadFromDictionary(LibTXD::TextureDictionary* dict) {
 std::unique_ptr<LibTXD::TextureDictionary> TXDModel::createDictionary() const {
     auto dict = std::make_unique<LibTXD::TextureDictionary>();
     dict->setVersion(version);
+    formatReport.entries.clear();
 
-    for (const auto& entry : entries) {
-        LibTXD::Texture texture;
-        texture.setName(entry.name.toStdString());
-        texture.setMaskName(entry.maskName.toStdString());
-        texture.setFilterFlags(entry.filterFlags);
-        texture.setHasAlpha(entry.hasAlpha);
-        texture.setPlatform(entry.platform);
-
-        // Determine compression based on compressionEnabled flag and alpha
-        LibTXD::Compression comp = LibTXD::Compression::NONE;
-        if (entry.compressionEnabled) {
-            comp = entry.hasAlpha ? LibTXD::Compression::DXT3 : LibTXD::Compression::DXT1;
-        }
-        texture.setCompression(comp);
+    // Textures are prepared in batches: mip chains are built for a batch, every
+    // DXT level in it is compressed in parallel, then textures are added in order.
+    // Batching bounds the memory held by uncompressed mip chains.
+    // Unedited textures keep their original encoding. With automatic formats they
+    // keep it only if selection picks the same format, so a save can still shrink them.
+    const size_t batchSize = 64;
 
-        // Generate mipmap data
-        LibTXD::MipmapLevel mipmap;
-        mipmap.width = entry.width;
-        mipmap.height = entry.height;
-        
-        if (comp != LibTXD::Compression::NONE) {
-            // Compress RGBA data to DXT
-            auto compressedData = LibTXD::TextureConverter::compressToDXT(
-                entry.diffuse.data(), entry.width, entry.height, comp, 1.0f);
-            if (compressedData) {
-                size_t compressedSize = LibTXD::TextureConverter::getCompressedDataSize(
-                    entry.width, entry.height, comp);
-                mipmap.data.assign(compressedData.get(), compressedData.get() + compressedSize);
-                mipmap.dataSize = mipmap.data.size();
-                
-                // DXT compressed: set raster format, depth 16
-                texture.setRasterFormat(entry.hasAlpha ? LibTXD::RasterFormat::B8G8R8A8 : LibTXD::RasterFormat::B8G8R8);
-                texture.setDepth(16);  // DXT uses 16-bit depth indicator
+    for (size_t batchStart = 0; batchStart < entries.size(); batchStart += batchSize) {
+        size_t batchEnd = std::min(entries.size(), batchStart + batchSize);
+
+        const size_t count = batchEnd - batchStart;
+        std::vector<std::vector<LibTXD::MipmapImage>> chains(count);
+        std::vector<LibTXD::FormatChoice> formats(count);
+        std::vector<size_t> defaultBytes(count, 0);
+        std::vector<size_t> firstJob(count, 0);
+        std::vector<LibTXD::CompressionJob> jobs;
+
+        std::vector<uint8_t> reuse(count, 0);
+        std::vector<size_t> pending;
+        for (size_t i = batchStart; i < batchEnd; ++i) {
+            if (canReuseOriginal(entries[i]) && !autoSelectFormats) {
+                reuse[i - batchStart] = 1;
             } else {
-                // Compression failed, fall back to uncompressed
-                comp = LibTXD::Compression::NONE;
-                texture.setCompression(comp);
+                pending.push_back(i - batchStart);
             }
         }
-        
-        if (comp == LibTXD::Compression::NONE) {
-            // Uncompressed - format and depth depend on alpha
-            // NOTE: GTA uses BGR byte order, diffuse is stored as RGBA
-            // Must swap R and B when writing
-            size_t pixelCount = entry.width * entry.height;
-            
+
+        auto selectionOptions = [this](const TXDFileEntry& entry) {
+            LibTXD::FormatSelectionOptions options = formatOptions;
+            options.allowDXT = options.allowDXT && entry.compressionEnabled;
+            return options;
+        };
+
+        // Mip chains and format choices are independent per texture, so they are
+        // built in parallel before the batch goes to the compressor
+        std::vector<uint8_t> invalid(count, 0);
+        const int pendingCount = static_cast<int>(pending.size());
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (int n = 0; n < pendingCount; ++n) {
+            const size_t slot = pending[static_cast<size_t>(n)];
+            const auto& entry = entries[batchStart + slot];
+            auto& format = formats[slot];
+
+            // The diffuse of an unedited texture is its decoded original, so selection
+            // can run on it before deciding whether a new chain is needed at all
+            const bool reusable = canReuseOriginal(entry);
+            if (reusable) {
+                format = LibTXD::TextureConverter::selectFormat(
+                    entry.diffuse.data(), entry.width, entry.height, selectionOptions(entry));
+                defaultBytes[slot] = originalBytes(*entry.original);
+                if (matchesOriginal(format, *entry.original)) {
+                    reuse[slot] = 1;
+                    continue;
+                }
+            }
+
+            // Build the full mip chain from the edited image
+            LibTXD::MipmapOptions mipOptions;
+            mipOptions.filter = LibTXD::MipmapFilter::Kaiser;
+            mipOptions.gammaCorrect = true;
+            // Keep stray colour under transparent pixels out of the filters and DXT blocks
             if (entry.hasAlpha) {
-                // B8G8R8A8 (32-bit BGRA)
-                texture.setRasterFormat(LibTXD::RasterFormat::B8G8R8A8);
-                texture.setDepth(32);
-                mipmap.data.resize(pixelCount * 4);
-                for (size_t i = 0; i < pixelCount; ++i) {
-                    mipmap.data[i * 4 + 0] = entry.diffuse[i * 4 + 2];  // B (from R)
-                    mipmap.data[i * 4 + 1] = entry.diffuse[i * 4 + 1];  // G
-                    mipmap.data[i * 4 + 2] = entry.diffuse[i * 4 + 0];  // R (from B)
-                    mipmap.data[i * 4 + 3] = entry.diffuse[i * 4 + 3];  // A
+                mipOptions.alphaPreprocess = LibTXD::AlphaPreprocess::Bleed;
+            }
+            auto& levels = chains[slot];
+            levels = LibTXD::TextureConverter::generateMipmaps(
+                entry.diffuse.data(), entry.width, entry.height, mipOptions);
+            if (levels.empty()) {
+                // No chain could be built: save level 0 alone rather than drop the
+                // texture, and fail the save if there is no valid image at all
+                const size_t expectedSize = static_cast<size_t>(entry.width) * entry.height * 4;
+                if (entry.width == 0 || entry.height == 0 || entry.diffuse.size() != expectedSize) {
+                    invalid[slot] = 1;
+                    continue;
                 }
-                mipmap.dataSize = mipmap.data.size();
-            } else {
-                // B8G8R8 (24-bit BGR) - strip alpha channel
-                texture.setRasterFormat(LibTXD::RasterFormat::B8G8R8);
-                texture.setDepth(24);
-                mipmap.data.resize(pixelCount * 3);
-                for (size_t i = 0; i < pixelCount; ++i) {
-                    mipmap.data[i * 3 + 0] = entry.diffuse[i * 4 + 2];  // B (from R)
-                    mipmap.data[i * 3 + 1] = entry.diffuse[i * 4 + 1];  // G
-                    mipmap.data[i * 3 + 2] = entry.diffuse[i * 4 + 0];  // R (from B)
+                LibTXD::MipmapImage base;
+                base.width = entry.width;
+                base.height = entry.height;
+                base.rgba = entry.diffuse;
+                levels.push_back(std::move(base));
+            }
+
+            // The format is chosen on level 0 and used for the whole chain
+            if (!reusable) {
+                format = defaultFormat(entry);
+                defaultBytes[slot] = format.bytes;
+                if (autoSelectFormats) {
+                    format = LibTXD::TextureConverter::selectFormat(
+                        levels[0].rgba.data(), levels[0].width, levels[0].height, selectionOptions(entry));
+                }
+            }
+        }
+
+        for (size_t slot : pending) {
+            if (invalid[slot]) {
+                return nullptr;
+            }
+            const auto& format = formats[slot];
+            if (autoSelectFormats) {
+                formatReport.entries.push_back({ entries[batchStart + slot].name.toStdString(), format.name,
+                                                 defaultBytes[slot], format.bytes, format.psnr });
+            }
+
+            if (reuse[slot]) {
+                continue;
+            }
+
+            firstJob[slot] = jobs.size();
+            if (format.compression != LibTXD::Compression::NONE) {
+                for (const auto& image : chains[slot]) {
+                    jobs.push_back({ image.rgba.data(), image.width, image.height, format.compression,
+                                     LibTXD::CompressionProfile::perceptual() });
                 }
-                mipmap.dataSize = mipmap.data.size();
             }
         }
+
+        auto compressed = LibTXD::TextureConverter::compressBatch(jobs);
+
+        for (size_t i = batchStart; i < batchEnd; ++i) {
+            const auto& entry = entries[i];
+            if (reuse[i - batchStart]) {
+                dict->addTexture(copyOriginalTexture(entry));
+                continue;
+            }
+            
+            const auto& levels = chains[i - batchStart];
+
+            LibTXD::Texture texture;
+            texture.setName(entry.name.toStdString());
+            texture.setMaskName(entry.maskName.toStdString());
+            texture.setFilterFlags(entry.filterFlags);
+            texture.setHasAlpha(entry.hasAlpha);
+            texture.setPlatform(entry.platform);
+
+            LibTXD::FormatChoice format = formats[i - batchStart];
+            std::vector<LibTXD::MipmapLevel> mipmaps;
+            mipmaps.reserve(levels.size());
+            
+            if (format.compression != LibTXD::Compression::NONE) {
+                for (size_t level = 0; level < levels.size(); ++level) {
+                    auto& compressedData = compressed[firstJob[i - batchStart] + level];
+                    if (compressedData.empty()) {
+                        mipmaps.clear();
+                        break;
+                    }
+                    
+                    LibTXD::MipmapLevel mipmap;
+                    // Small DXT levels are stored (and read back) as one whole 4x4 block
+                    LibTXD::Texture::getMipmapDimensions(entry.width, entry.height, static_cast<uint32_t>(level),
+                                                         format.compression, mipmap.width, mipmap.height);
+                    mipmap.data = std::move(compressedData);
+                    mipmap.dataSize = mipmap.data.size();
+                    mipmaps.push_back(std::move(mipmap));
+                }
+                
+                if (mipmaps.empty()) {
+                    // Compression failed, fall back to uncompressed
+                    format.compression = LibTXD::Compression::NONE;
+                    format.rasterFormat = uncompressedFormat(entry);
+                    format.depth = LibTXD::TextureConverter::getUncompressedPixelSize(format.rasterFormat) * 8;
+                }
+            } else if (format.paletteSize > 0) {
+                // One palette shared by every level, indices stored one per byte
+                std::vector<LibTXD::ImageView> views;
+                for (const auto& image : levels) {
+                    views.push_back({ image.rgba.data(), image.width, image.height });
+                }
+                std::vector<uint8_t> palette;
+                std::vector<std::vector<uint8_t>> indices;
+                if (LibTXD::TextureConverter::generateSharedPalette(views, format.paletteSize, palette, indices,
+                                                                    formatOptions.paletteOptions)) {
+                    texture.setPalette(palette, format.paletteSize);
+                    for (size_t level = 0; level < levels.size(); ++level) {
+                        LibTXD::MipmapLevel mipmap;
+                        mipmap.width = levels[level].width;
+                        mipmap.height = levels[level].height;
+                        mipmap.data = std::move(indices[level]);
+                        mipmap.dataSize = mipmap.data.size();
+                        mipmaps.push_back(std::move(mipmap));
+                    }
+                } else {
+                    format.paletteSize = 0;
+                    format.rasterFormat = entry.hasAlpha ? LibTXD::RasterFormat::B8G8R8A8 : LibTXD::RasterFormat::B8G8R8;
+                    format.depth = LibTXD::TextureConverter::getUncompressedPixelSize(format.rasterFormat) * 8;
+                }
+            }
+            texture.setCompression(format.compression);
+            texture.setRasterFormat(format.rasterFormat);
+            texture.setDepth(format.depth);
         
-        texture.addMipmap(std::move(mipmap));
-        dict->addTexture(std::move(texture));
+            if (mipmaps.empty()) {
+                // Uncompressed - GTA stores BGR(A) byte order, diffuse is RGBA
+                uint32_t pixelSize = LibTXD::TextureConverter::getUncompressedPixelSize(format.rasterFormat);
+                for (const auto& image : levels) {
+                    LibTXD::MipmapLevel mipmap;
+                    mipmap.width = image.width;
+                    mipmap.height = image.height;
+                    mipmap.data.resize(static_cast<size_t>(image.width) * image.height * pixelSize);
+                    LibTXD::TextureConverter::encodeUncompressed(image.rgba.data(), image.width, image.height,
+                                                                 format.rasterFormat, mipmap.data.mutableData(), ditherMode);
+                    mipmap.dataSize = mipmap.data.size();
+                    mipmaps.push_back(std::move(mipmap));
+                }
+            }
+        
+            if (mipmaps.size() > 1) {
+                texture.setRasterFormat(static_cast<LibTXD::RasterFormat>(
+                    static_cast<uint32_t>(texture.getRasterFormat()) | static_cast<uint32_t>(LibTXD::RasterFormat::MIPMAP)));
+            }
+            for (auto& mipmap : mipmaps) {
+                texture.addMipmap(std::move(mipmap));
+            }
+            dict->addTexture(std::move(texture));
+        }
     }
 
     return dict;
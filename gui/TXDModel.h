@@ -7,10 +7,12 @@
 #include <vector>
 #include <memory>
 #include "libtxd/txd_types.h"
+#include "libtxd/txd_converter.h"
 
 // Forward declarations
 namespace LibTXD {
     class TextureDictionary;
+    class Texture;
 }
 
 // Simple texture entry - just holds data for presentation
@@ -18,8 +20,9 @@ struct TXDFileEntry {
     // Metadata
     QString name;
     QString maskName;
-    LibTXD::RasterFormat rasterFormat;  // Original format (informational only, recalculated on save)
+    LibTXD::RasterFormat rasterFormat;  // Uncompressed saves keep 16-bit and LUM8 formats, others are recalculated
     bool compressionEnabled;  // Just a flag - compression happens on save
+    LibTXD::Compression compressionFormat = LibTXD::Compression::NONE;  // DXT format to save with, NONE picks by alpha
     uint32_t width;
     uint32_t height;
     bool hasAlpha;
@@ -33,6 +36,23 @@ struct TXDFileEntry {
     // Uncompressed data for display and editing (always RGBA8888)
     std::vector<uint8_t> diffuse;  // RGB + Alpha (if hasAlpha is true, alpha channel is meaningful)
     
+    // Encoded texture as loaded from file (null for new textures). Written back
+    // verbatim on save unless the pixels, alpha or compression setting changed.
+    std::shared_ptr<const LibTXD::Texture> original;
+    bool pixelsDirty = false;  // Set whenever diffuse is edited
+    
+    // DXT format used on save, NONE when compression is off. Without an explicit
+    // format, textures with alpha use DXT3 and others DXT1.
+    LibTXD::Compression getSaveCompression() const {
+        if (!compressionEnabled) {
+            return LibTXD::Compression::NONE;
+        }
+        if (compressionFormat != LibTXD::Compression::NONE) {
+            return compressionFormat;
+        }
+        return hasAlpha ? LibTXD::Compression::DXT3 : LibTXD::Compression::DXT1;
+    }
+    
     // Helper: Get combined RGBA (for preview)
     std::vector<uint8_t> getRGBA() const {
         return diffuse;
@@ -40,23 +60,17 @@ struct TXDFileEntry {
     
     // Helper: Get RGB only (for diffuse view)
     std::vector<uint8_t> getRGB() const {
-        std::vector<uint8_t> rgb;
-        rgb.reserve(width * height * 3);
-        for (size_t i = 0; i < diffuse.size(); i += 4) {
-            rgb.push_back(diffuse[i]);     // R
-            rgb.push_back(diffuse[i + 1]); // G
-            rgb.push_back(diffuse[i + 2]); // B
-        }
+        const size_t pixelCount = diffuse.size() / 4;
+        std::vector<uint8_t> rgb(pixelCount * 3);
+        LibTXD::TextureConverter::stripAlpha(diffuse.data(), pixelCount, rgb.data());
         return rgb;
     }
     
     // Helper: Get alpha channel only
     std::vector<uint8_t> getAlpha() const {
-        std::vector<uint8_t> alpha;
-        alpha.reserve(width * height);
-        for (size_t i = 3; i < diffuse.size(); i += 4) {
-            alpha.push_back(diffuse[i]);
-        }
+        const size_t pixelCount = diffuse.size() / 4;
+        std::vector<uint8_t> alpha(pixelCount);
+        LibTXD::TextureConverter::extractAlpha(diffuse.data(), pixelCount, alpha.data());
         return alpha;
     }
 };
@@ -81,6 +95,18 @@ public:
     QString getFilePath() const { return filePath; }
     void setVersion(uint32_t v) { version = v; setModified(true); }
     void setGameVersion(LibTXD::GameVersion gv) { gameVersion = gv; }
+    
+    // Dithering used when saving textures in 16-bit formats
+    LibTXD::DitherMode getDitherMode() const { return ditherMode; }
+    void setDitherMode(LibTXD::DitherMode mode) { ditherMode = mode; }
+
+    // Pick the format of each re-encoded texture from its pixels instead of the
+    // compression flag and alpha. The report covers the textures of the last save.
+    bool getAutoSelectFormats() const { return autoSelectFormats; }
+    void setAutoSelectFormats(bool enabled) { autoSelectFormats = enabled; }
+    const LibTXD::FormatSelectionOptions& getFormatSelectionOptions() const { return formatOptions; }
+    void setFormatSelectionOptions(const LibTXD::FormatSelectionOptions& options) { formatOptions = options; }
+    const LibTXD::FormatSelectionReport& getFormatReport() const { return formatReport; }
 
     // Texture access
     size_t getTextureCount() const { return entries.size(); }
@@ -116,6 +142,10 @@ private:
     uint32_t version;
     bool modified;
     QString filePath;
+    LibTXD::DitherMode ditherMode;
+    bool autoSelectFormats;
+    LibTXD::FormatSelectionOptions formatOptions;
+    mutable LibTXD::FormatSelectionReport formatReport;
 };
 
 #endif // TXD_MODEL_H
@@ -11,6 +11,8 @@
 #include <QContextMenuEvent>
 #include <QMenu>
 #include <QAction>
+#include <algorithm>
+#include <vector>
 
 TextureListWidget::TextureListWidget(QWidget *parent)
     : QListWidget(parent) {
@@ -25,8 +27,21 @@ QString TextureListWidget::formatTextureInfo(const TXDFileEntry* entry) const {
         return "Invalid texture";
     }
     
-    QString compressionStr = entry->compressionEnabled ? 
-        (entry->hasAlpha ? "DXT3" : "DXT1") : "None";
+    QString compressionStr;
+    switch (entry->getSaveCompression()) {
+        case LibTXD::Compression::DXT1:
+            compressionStr = entry->hasAlpha ? "DXT1 (1-bit alpha)" : "DXT1";
+            break;
+        case LibTXD::Compression::DXT3:
+            compressionStr = "DXT3";
+            break;
+        case LibTXD::Compression::DXT5:
+            compressionStr = "DXT5";
+            break;
+        default:
+            compressionStr = "None";
+            break;
+    }
     
     QString info = QString("Name: %1\nSize: %2x%3px\nHas alpha: %4\nCompression: %5")
         .arg(entry->name)
@@ -43,6 +58,21 @@ QPixmap TextureListWidget::createThumbnail(const uint8_t* rgbaData, int width, i
         return QPixmap();
     }
     
+    // Shrink to fit 32x32 in linear light so that fine detail does not darken
+    // the thumbnail
+    std::vector<uint8_t> reduced;
+    uint32_t thumbWidth, thumbHeight;
+    LibTXD::TextureConverter::getResizeDimensions(width, height, 32, LibTXD::PowerOfTwoRounding::None,
+                                                  thumbWidth, thumbHeight);
+    if (thumbWidth != static_cast<uint32_t>(width) || thumbHeight != static_cast<uint32_t>(height)) {
+        reduced.resize(static_cast<size_t>(thumbWidth) * thumbHeight * 4);
+        LibTXD::TextureConverter::resizeRGBA(rgbaData, width, height, reduced.data(), thumbWidth, thumbHeight,
+                                             LibTXD::ResizeFilter::Box, true);
+        rgbaData = reduced.data();
+        width = static_cast<int>(thumbWidth);
+        height = static_cast<int>(thumbHeight);
+    }
+    
     // Create QImage directly from RGBA data
     QImage image(rgbaData, width, height, QImage::Format_RGBA8888);
     QImage imageCopy = image.copy();
@@ -58,13 +88,7 @@ QPixmap TextureListWidget::createThumbnail(const uint8_t* rgbaData, int width, i
         imageCopy = result.toImage();
     }
     
-    // Create thumbnail (32x32 max)
-    QPixmap pixmap = QPixmap::fromImage(imageCopy);
-    if (pixmap.width() > 32 || pixmap.height() > 32) {
-        pixmap = pixmap.scaled(32, 32, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    }
-    
-    return pixmap;
+    return QPixmap::fromImage(imageCopy);
 }
 
 void TextureListWidget::addTexture(const TXDFileEntry* entry, int index) {
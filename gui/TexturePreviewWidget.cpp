@@ -2,6 +2,7 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QImage>
+#include <vector>
 
 TexturePreviewWidget::TexturePreviewWidget(QWidget *parent)
     : QWidget(parent)
@@ -129,13 +130,9 @@ QPixmap TexturePreviewWidget::createImagePixmap(const uint8_t* rgbaData, int wid
     
     if (showAlpha) {
         // Show only alpha channel as grayscale
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                QRgb pixel = imageCopy.pixel(x, y);
-                uint8_t alpha = qAlpha(pixel);
-                imageCopy.setPixel(x, y, qRgb(alpha, alpha, alpha));
-            }
-        }
+        std::vector<uint8_t> alphaPlane(static_cast<size_t>(width) * height);
+        LibTXD::TextureConverter::extractAlpha(rgbaData, alphaPlane.size(), alphaPlane.data());
+        imageCopy = QImage(alphaPlane.data(), width, height, width, QImage::Format_Grayscale8).copy();
     } else if (mixed) {
         // Show RGB with alpha as checkerboard pattern
         QPixmap checkerPattern(16, 16);
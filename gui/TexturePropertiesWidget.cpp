@@ -5,6 +5,7 @@
 #include <QLabel>
 #include <QFontMetrics>
 #include <cstring>
+#include <algorithm>
 
 TexturePropertiesWidget::TexturePropertiesWidget(QWidget *parent)
     : QWidget(parent), currentEntry(nullptr) {
@@ -50,11 +51,8 @@ TexturePropertiesWidget::TexturePropertiesWidget(QWidget *parent)
     mipmapLabel = new QLabel("1", contentWidget);
     propsLayout->addRow("Mipmaps:", mipmapLabel);
     
-    // Format label (read-only)
+    // Format label (compressed textures) or combo (uncompressed textures)
     formatLabel = new QLabel("", contentWidget);
-    propsLayout->addRow("Raster format:", formatLabel);
-    
-    // Format combo (hidden, kept for compatibility)
     formatCombo = new QComboBox(contentWidget);
     QListView* formatView = new QListView();
     formatView->setSpacing(0);
@@ -67,17 +65,40 @@ TexturePropertiesWidget::TexturePropertiesWidget(QWidget *parent)
     formatCombo->addItem("A1R5G5B5", static_cast<uint32_t>(LibTXD::RasterFormat::A1R5G5B5));
     formatCombo->addItem("R4G4B4A4", static_cast<uint32_t>(LibTXD::RasterFormat::R4G4B4A4));
     formatCombo->addItem("LUM8", static_cast<uint32_t>(LibTXD::RasterFormat::LUM8));
-    formatCombo->hide(); // Always hidden - format is auto-determined
+    formatCombo->hide();
+    connect(formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TexturePropertiesWidget::onFormatChanged);
+    QHBoxLayout* formatLayout = new QHBoxLayout();
+    formatLayout->setContentsMargins(0, 0, 0, 0);
+    formatLayout->addWidget(formatLabel);
+    formatLayout->addWidget(formatCombo);
+    propsLayout->addRow("Raster format:", formatLayout);
     
     alphaCheck = new CheckBox("", contentWidget);
     connect(alphaCheck, &QCheckBox::toggled, this, &TexturePropertiesWidget::onAlphaChannelToggled);
     propsLayout->addRow("Use alpha:", alphaCheck);
     
     compressionCheck = new CheckBox("", contentWidget);
-    propsLayout->addRow("Use compression:", compressionCheck);
+    compressionCombo = new QComboBox(contentWidget);
+    QListView* compressionView = new QListView();
+    compressionView->setSpacing(0);
+    compressionView->setUniformItemSizes(true);
+    compressionCombo->setView(compressionView);
+    compressionCombo->setEditable(false);
+    compressionCombo->addItem("Auto", static_cast<uint32_t>(LibTXD::Compression::NONE));
+    compressionCombo->addItem("DXT1", static_cast<uint32_t>(LibTXD::Compression::DXT1));
+    compressionCombo->addItem("DXT3", static_cast<uint32_t>(LibTXD::Compression::DXT3));
+    compressionCombo->addItem("DXT5", static_cast<uint32_t>(LibTXD::Compression::DXT5));
+    compressionCombo->hide();
+    QHBoxLayout* compressionLayout = new QHBoxLayout();
+    compressionLayout->setContentsMargins(0, 0, 0, 0);
+    compressionLayout->addWidget(compressionCheck);
+    compressionLayout->addWidget(compressionCombo);
+    compressionLayout->addStretch();
+    propsLayout->addRow("Use compression:", compressionLayout);
     
     // Connect compression changes
     connect(compressionCheck, &QCheckBox::toggled, this, &TexturePropertiesWidget::onCompressionToggled);
+    connect(compressionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TexturePropertiesWidget::onCompressionFormatChanged);
     
     contentLayout->addWidget(propertiesGroup);
     
@@ -213,6 +234,10 @@ void TexturePropertiesWidget::clear() {
     formatCombo->hide();
     formatLabel->hide();
     compressionCheck->setChecked(false);
+    compressionCombo->blockSignals(true);
+    compressionCombo->setCurrentIndex(0);
+    compressionCombo->blockSignals(false);
+    compressionCombo->hide();
     filterCombo->setCurrentIndex(0);
     uWrapCombo->setCurrentIndex(0);
     vWrapCombo->setCurrentIndex(0);
@@ -279,14 +304,23 @@ void TexturePropertiesWidget::updateUI() {
         formatText = QString("Unknown (0x%1)").arg(baseFormat, 4, 16, QChar('0')).toUpper();
     }
     
-    // Format is read-only for both new and existing textures (auto-set for new, preserved for existing)
-    // Always show as label (plain text)
-    formatCombo->hide();
-    formatLabel->show();
+    // Uncompressed textures can pick their raster format; B8G8R8A8 and B8G8R8
+    // follow the alpha setting on save
     formatLabel->setText(formatText);
+    int formatIndex = formatCombo->findData(baseFormat);
+    bool formatEditable = !currentEntry->compressionEnabled && formatIndex >= 0;
+    if (formatEditable) {
+        formatCombo->setCurrentIndex(formatIndex);
+    }
+    formatCombo->setVisible(formatEditable);
+    formatLabel->setVisible(!formatEditable);
     
-    // Set compression checkbox
+    // Set compression checkbox and, for compressed textures, the DXT format
+    // (DXT1 keeps alpha as 1-bit punch-through)
     compressionCheck->setChecked(currentEntry->compressionEnabled);
+    int compressionIndex = compressionCombo->findData(static_cast<uint32_t>(currentEntry->compressionFormat));
+    compressionCombo->setCurrentIndex(std::max(compressionIndex, 0));
+    compressionCombo->setVisible(currentEntry->compressionEnabled);
     
     // Set filter
     uint32_t filter = currentEntry->filterFlags;
@@ -311,6 +345,7 @@ void TexturePropertiesWidget::blockSignals(bool block) {
     alphaCheck->blockSignals(block);
     formatCombo->blockSignals(block);
     compressionCheck->blockSignals(block);
+    compressionCombo->blockSignals(block);
     filterCombo->blockSignals(block);
     uWrapCombo->blockSignals(block);
     vWrapCombo->blockSignals(block);
@@ -355,6 +390,7 @@ void TexturePropertiesWidget::onAlphaChannelToggled(bool enabled) {
                 currentEntry->diffuse[i + 3] = 255; // Fully opaque after compositing
             }
         }
+        currentEntry->pixelsDirty = true;
     }
     
     // Update alpha flag
@@ -370,6 +406,30 @@ void TexturePropertiesWidget::onCompressionToggled(bool enabled) {
     
     // Just update the flag - compression happens on save
     currentEntry->compressionEnabled = enabled;
+    updateUI();
+    
+    emit propertyChanged();
+}
+
+void TexturePropertiesWidget::onCompressionFormatChanged(int index) {
+    if (!currentEntry || index < 0) {
+        return;
+    }
+    
+    // Just update the format - compression happens on save
+    currentEntry->compressionFormat = static_cast<LibTXD::Compression>(compressionCombo->itemData(index).toUInt());
+    
+    emit propertyChanged();
+}
+
+void TexturePropertiesWidget::onFormatChanged(int index) {
+    if (!currentEntry || index < 0) {
+        return;
+    }
+    
+    // Just update the format - encoding happens on save
+    currentEntry->rasterFormat = static_cast<LibTXD::RasterFormat>(formatCombo->itemData(index).toUInt());
+    formatLabel->setText(formatCombo->itemText(index));
     
     emit propertyChanged();
 }
@@ -31,6 +31,8 @@ private slots:
     void onAlphaNameChanged();
     void onAlphaChannelToggled(bool enabled);
     void onCompressionToggled(bool enabled);
+    void onCompressionFormatChanged(int index);
+    void onFormatChanged(int index);
 
 private:
     void updateUI();
@@ -49,8 +51,9 @@ private:
     QLabel* mipmapLabel;
     CheckBox* alphaCheck;
     QLabel* formatLabel;
-    QComboBox* formatCombo;  // Hidden, kept for compatibility
+    QComboBox* formatCombo;  // Shown instead of formatLabel for uncompressed textures
     CheckBox* compressionCheck;
+    QComboBox* compressionCombo;  // DXT format, shown while compression is enabled
     
     QGroupBox* flagsGroup;
     QComboBox* filterCombo;
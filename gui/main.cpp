@@ -4,6 +4,8 @@
 #include <QIcon>
 #include <QDir>
 #include <QFile>
+#include <QStandardPaths>
+#include "libtxd/txd_converter.h"
 
 QString findIconPath(const QString& iconName) {
     // Use Qt resource system
@@ -39,6 +41,15 @@ int main(int argc, char *argv[]) {
     // Use native style
     app.setStyle(QStyleFactory::create("Fusion"));
     
+    // Keep encoded textures between sessions so unchanged images are not recompressed.
+    // The least recently used entries are dropped once the cache passes 256 MB.
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheDir.isEmpty()) {
+        const uint64_t cacheLimit = 256ull * 1024 * 1024;
+        LibTXD::TextureConverter::setCompressionCache(std::make_shared<LibTXD::CompressionCache>(
+            QDir(cacheDir).filePath("compression").toStdString(), cacheLimit));
+    }
+    
     MainWindow window;
     window.setWindowIcon(app.windowIcon());
     window.show();
@@ -0,0 +1,260 @@
+#include "txd_cache.h"
+#include "txd_types.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <cstdio>
+#include <algorithm>
+
+namespace LibTXD {
+
+namespace {
+
+constexpr uint32_t kCacheMagic = 0x43445854;  // "TXDC"
+
+// Bump whenever an encoder changes its output so stale entries are ignored
+constexpr uint32_t kCacheFormatVersion = 1;
+
+void writeU32(std::ostream& stream, uint32_t value) {
+    value = toLittleEndian32(value);
+    stream.write(reinterpret_cast<const char*>(&value), 4);
+}
+
+void writeU64(std::ostream& stream, uint64_t value) {
+    writeU32(stream, static_cast<uint32_t>(value));
+    writeU32(stream, static_cast<uint32_t>(value >> 32));
+}
+
+bool readU32(std::istream& stream, uint32_t& value) {
+    stream.read(reinterpret_cast<char*>(&value), 4);
+    if (stream.gcount() != 4) {
+        return false;
+    }
+    value = fromLittleEndian32(value);
+    return true;
+}
+
+bool readU64(std::istream& stream, uint64_t& value) {
+    uint32_t lo, hi;
+    if (!readU32(stream, lo) || !readU32(stream, hi)) {
+        return false;
+    }
+    value = (static_cast<uint64_t>(hi) << 32) | lo;
+    return true;
+}
+
+} // namespace
+
+CompressionCache::CompressionCache(const std::string& directory, uint64_t maxBytes)
+    : directory(directory), maxBytes(maxBytes) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    // Measures what earlier sessions left behind and trims it to the limit
+    std::lock_guard<std::mutex> lock(mutex);
+    pruneLocked();
+}
+
+std::string CompressionCache::getEntryPath(const CacheKey& key) const {
+    uint64_t name = hashData(&key.width, sizeof(key.width), key.pixelHash);
+    name = hashData(&key.height, sizeof(key.height), name);
+    name = hashData(&key.format, sizeof(key.format), name);
+    name = hashData(&key.settings, sizeof(key.settings), name);
+
+    char fileName[32];
+    std::snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(name));
+    return (std::filesystem::path(directory) / fileName).string();
+}
+
+bool CompressionCache::load(const CacheKey& key, std::vector<uint8_t>& data) const {
+    std::string path = getEntryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        misses++;
+        return false;
+    }
+
+    // The stored key guards against file name collisions
+    uint32_t magic, version;
+    CacheKey stored;
+    uint64_t size;
+    if (!readU32(file, magic) || magic != kCacheMagic ||
+        !readU32(file, version) || version != kCacheFormatVersion ||
+        !readU64(file, stored.pixelHash) || !readU32(file, stored.width) || !readU32(file, stored.height) ||
+        !readU32(file, stored.format) || !readU64(file, stored.settings) ||
+        !readU64(file, size) || stored != key) {
+        misses++;
+        return false;
+    }
+
+    // The payload runs to the end of the file; check the stored size against
+    // what is actually there before allocating for it
+    const std::streampos payloadStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streampos fileEnd = file.tellg();
+    if (payloadStart < 0 || fileEnd < payloadStart ||
+        static_cast<uint64_t>(fileEnd - payloadStart) != size) {
+        misses++;
+        return false;
+    }
+    file.seekg(payloadStart);
+
+    data.resize(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    if (static_cast<uint64_t>(file.gcount()) != size) {
+        data.clear();
+        misses++;
+        return false;
+    }
+    file.close();
+
+    // The modification time doubles as the last use time for pruning
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+    hits++;
+    return true;
+}
+
+bool CompressionCache::store(const CacheKey& key, const uint8_t* data, size_t size) {
+    if (!data && size > 0) {
+        return false;
+    }
+
+    static std::atomic<uint64_t> counter{0};
+    std::string path = getEntryPath(key);
+    std::string tempPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+                           "_" + std::to_string(counter++);
+
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        writeU32(file, kCacheMagic);
+        writeU32(file, kCacheFormatVersion);
+        writeU64(file, key.pixelHash);
+        writeU32(file, key.width);
+        writeU32(file, key.height);
+        writeU32(file, key.format);
+        writeU64(file, key.settings);
+        writeU64(file, size);
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    uint64_t entryBytes = std::filesystem::file_size(tempPath, ec);
+    if (ec) {
+        entryBytes = 0;
+    }
+    uint64_t replacedBytes = std::filesystem::file_size(path, ec);
+    if (ec) {
+        replacedBytes = 0;
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    totalBytes = totalBytes - std::min(totalBytes, replacedBytes) + entryBytes;
+    if (maxBytes > 0 && totalBytes > maxBytes) {
+        pruneLocked();
+    }
+    return true;
+}
+
+void CompressionCache::clear() {
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(directory, ec);
+         !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        if (it->path().extension() == ".bin") {
+            std::error_code removeError;
+            std::filesystem::remove(it->path(), removeError);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    totalBytes = 0;
+}
+
+void CompressionCache::setMaxBytes(uint64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxBytes = maxBytes;
+    if (maxBytes > 0 && totalBytes > maxBytes) {
+        pruneLocked();
+    }
+}
+
+uint64_t CompressionCache::getMaxBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxBytes;
+}
+
+uint64_t CompressionCache::getTotalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalBytes;
+}
+
+void CompressionCache::prune() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pruneLocked();
+}
+
+void CompressionCache::pruneLocked() {
+    struct Entry {
+        std::filesystem::file_time_type lastUse;
+        uint64_t size;
+        std::filesystem::path path;
+    };
+
+    // Rescan rather than trust totalBytes, other processes may share the directory
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(directory, ec);
+         !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        if (it->path().extension() != ".bin") {
+            continue;
+        }
+        std::error_code entryError;
+        uint64_t size = it->file_size(entryError);
+        auto lastUse = it->last_write_time(entryError);
+        if (entryError) {
+            continue;
+        }
+        entries.push_back({ lastUse, size, it->path() });
+        total += size;
+    }
+
+    totalBytes = total;
+    if (maxBytes == 0 || total <= maxBytes) {
+        return;
+    }
+
+    // Trim to 7/8 of the limit so the next few stores do not rescan again
+    const uint64_t target = maxBytes - maxBytes / 8;
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+    for (const Entry& entry : entries) {
+        if (total <= target) {
+            break;
+        }
+        std::error_code removeError;
+        if (std::filesystem::remove(entry.path, removeError)) {
+            total -= entry.size;
+        }
+    }
+    totalBytes = total;
+}
+
+} // namespace LibTXD
@@ -0,0 +1,84 @@
+#ifndef TXD_CACHE_H
+#define TXD_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+namespace LibTXD {
+
+// Identifies one encoded result: what was encoded and how
+struct CacheKey {
+    uint64_t pixelHash = 0;  // hashData over the RGBA8 input
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;     // Target format tag chosen by the encoder
+    uint64_t settings = 0;   // Hash of every encoder setting that affects the output
+
+    bool operator==(const CacheKey& other) const {
+        return pixelHash == other.pixelHash && width == other.width && height == other.height &&
+               format == other.format && settings == other.settings;
+    }
+    bool operator!=(const CacheKey& other) const { return !(*this == other); }
+};
+
+// Persistent on-disk store of encoded texture data, one file per key
+// Entries are written to a temporary file and renamed into place, so the cache
+// can be shared by threads and by several processes. Unreadable or mismatching
+// entries are treated as misses.
+// With a byte limit set, the least recently used entries are removed whenever
+// the directory grows past it. Loads count as a use.
+class CompressionCache {
+public:
+    // maxBytes 0 leaves the cache unbounded
+    explicit CompressionCache(const std::string& directory, uint64_t maxBytes = 0);
+
+    // Non-copyable
+    CompressionCache(const CompressionCache&) = delete;
+    CompressionCache& operator=(const CompressionCache&) = delete;
+
+    const std::string& getDirectory() const { return directory; }
+
+    // Returns true and fills data if an entry for key exists
+    bool load(const CacheKey& key, std::vector<uint8_t>& data) const;
+
+    // Stores an entry, replacing any existing one. Returns false on I/O failure.
+    bool store(const CacheKey& key, const uint8_t* data, size_t size);
+
+    // Remove every entry
+    void clear();
+
+    // Byte limit for all entries together, 0 for none. Lowering it prunes at once.
+    void setMaxBytes(uint64_t maxBytes);
+    uint64_t getMaxBytes() const;
+
+    // Bytes held by the entries, as of the last scan plus this object's stores
+    uint64_t getTotalBytes() const;
+
+    // Remove least recently used entries until the cache fits its limit
+    void prune();
+
+    // Lookup statistics since construction
+    uint64_t getHitCount() const { return hits.load(); }
+    uint64_t getMissCount() const { return misses.load(); }
+
+private:
+    std::string directory;
+    mutable std::atomic<uint64_t> hits{0};
+    mutable std::atomic<uint64_t> misses{0};
+
+    mutable std::mutex mutex;  // Guards maxBytes and totalBytes
+    uint64_t maxBytes = 0;
+    uint64_t totalBytes = 0;
+
+    void pruneLocked();
+
+    std::string getEntryPath(const CacheKey& key) const;
+};
+
+} // namespace LibTXD
+
+#endif // TXD_CACHE_H
@@ -4,196 +4,3408 @@
 #include <cstring>
 #include <algorithm>
 #include <stdexcept>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <array>
+#include <atomic>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIBTXD_USE_SSE2 1
+#endif
 
 namespace LibTXD {
 
-std::unique_ptr<uint8_t[]> TextureConverter::decompressDXT(
-    const uint8_t* compressedData,
+namespace {
+
+// Real-time DXT encoding after J.M.P. van Waveren's "Real-Time DXT Compression"
+// and stb_dxt: endpoints come from the inset colour bounding box and every pixel
+// is projected onto the endpoint axis to pick its index. Everything is integer.
+
+// Gathers a 4x4 block, replicating edge pixels for partial blocks so they do
+// not widen the bounding box
+inline void loadBlock(const uint8_t* rgba, uint32_t width, uint32_t height,
+                      uint32_t bx, uint32_t by, uint8_t* block) {
+    for (uint32_t py = 0; py < 4; py++) {
+        uint32_t sy = std::min(by + py, height - 1);
+        const uint8_t* row = rgba + static_cast<size_t>(sy) * width * 4;
+        if (bx + 4 <= width) {
+            std::memcpy(block + py * 16, row + bx * 4, 16);
+        } else {
+            for (uint32_t px = 0; px < 4; px++) {
+                uint32_t sx = std::min(bx + px, width - 1);
+                std::memcpy(block + (py * 4 + px) * 4, row + sx * 4, 4);
+            }
+        }
+    }
+}
+
+// Rounds an 8-bit channel to n bits with the same rounding the hardware expands with
+inline int quantizeChannel(int value, int maxValue) {
+    int t = value * maxValue + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+inline uint16_t packRGB565(const uint8_t* c) {
+    return static_cast<uint16_t>((quantizeChannel(c[0], 31) << 11) |
+                                 (quantizeChannel(c[1], 63) << 5) |
+                                 quantizeChannel(c[2], 31));
+}
+
+inline uint8_t expand5(int v) {
+    return static_cast<uint8_t>((v << 3) | (v >> 2));
+}
+
+inline uint8_t expand6(int v) {
+    return static_cast<uint8_t>((v << 2) | (v >> 4));
+}
+
+inline void unpackRGB565(uint16_t c, int* out) {
+    out[0] = expand5((c >> 11) & 0x1F);
+    out[1] = expand6((c >> 5) & 0x3F);
+    out[2] = expand5(c & 0x1F);
+}
+
+inline void blockBounds(const uint8_t* block, uint8_t* minColour, uint8_t* maxColour) {
+#ifdef LIBTXD_USE_SSE2
+    __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+    __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 32));
+    __m128i p3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 48));
+    __m128i lo = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+    __m128i hi = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+    lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+    hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    lo = _mm_min_epu8(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+    hi = _mm_max_epu8(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint32_t minPacked = static_cast<uint32_t>(_mm_cvtsi128_si32(lo));
+    uint32_t maxPacked = static_cast<uint32_t>(_mm_cvtsi128_si32(hi));
+    std::memcpy(minColour, &minPacked, 4);
+    std::memcpy(maxColour, &maxPacked, 4);
+#else
+    for (int c = 0; c < 4; c++) {
+        minColour[c] = 255;
+        maxColour[c] = 0;
+    }
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            minColour[c] = std::min(minColour[c], block[i * 4 + c]);
+            maxColour[c] = std::max(maxColour[c], block[i * 4 + c]);
+        }
+    }
+#endif
+}
+
+// Computes the 32 index bits for a 4-colour block with endpoints p0 (index 0) and p1 (index 1)
+inline uint32_t selectIndices(const uint8_t* block, const int* p0, const int* p1) {
+    int dir[3] = { p0[0] - p1[0], p0[1] - p1[1], p0[2] - p1[2] };
+    int d0 = p0[0] * dir[0] + p0[1] * dir[1] + p0[2] * dir[2];
+    int d1 = p1[0] * dir[0] + p1[1] * dir[1] + p1[2] * dir[2];
+    
+    // Midpoints between the stops p1, 2/3 p1 + 1/3 p0, 1/3 p1 + 2/3 p0, p0, scaled by 6
+    int t0 = 5 * d1 + d0;
+    int t1 = 3 * d1 + 3 * d0;
+    int t2 = d1 + 5 * d0;
+    
+    int steps[16];
+#ifdef LIBTXD_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i dirv = _mm_setr_epi16(static_cast<int16_t>(dir[0]), static_cast<int16_t>(dir[1]),
+                                        static_cast<int16_t>(dir[2]), 0,
+                                        static_cast<int16_t>(dir[0]), static_cast<int16_t>(dir[1]),
+                                        static_cast<int16_t>(dir[2]), 0);
+    const __m128i t0v = _mm_set1_epi32(t0);
+    const __m128i t1v = _mm_set1_epi32(t1);
+    const __m128i t2v = _mm_set1_epi32(t2);
+    for (int i = 0; i < 4; i++) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        __m128i mlo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), dirv);
+        __m128i mhi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), dirv);
+        __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(mlo), _mm_castsi128_ps(mhi),
+                                                       _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(mlo), _mm_castsi128_ps(mhi),
+                                                      _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i dot = _mm_add_epi32(even, odd);
+        dot = _mm_add_epi32(_mm_slli_epi32(dot, 2), _mm_slli_epi32(dot, 1));
+        __m128i count = _mm_add_epi32(_mm_add_epi32(_mm_cmpgt_epi32(dot, t0v), _mm_cmpgt_epi32(dot, t1v)),
+                                      _mm_cmpgt_epi32(dot, t2v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(steps + i * 4), _mm_sub_epi32(zero, count));
+    }
+#else
+    for (int i = 0; i < 16; i++) {
+        const uint8_t* px = block + i * 4;
+        int dot = 6 * (px[0] * dir[0] + px[1] * dir[1] + px[2] * dir[2]);
+        steps[i] = (dot > t0) + (dot > t1) + (dot > t2);
+    }
+#endif
+    
+    // Steps 0..3 run from p1 to p0, which are indices 1, 3, 2, 0 (Gray code of step + 1)
+    uint32_t indices = 0;
+    for (int i = 0; i < 16; i++) {
+        uint32_t g = static_cast<uint32_t>(steps[i] + 1) & 3;
+        indices |= (g ^ (g >> 1)) << (i * 2);
+    }
+    return indices;
+}
+
+inline void writeColourBlock(uint16_t c0, uint16_t c1, uint32_t indices, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(c0 & 0xFF);
+    out[1] = static_cast<uint8_t>(c0 >> 8);
+    out[2] = static_cast<uint8_t>(c1 & 0xFF);
+    out[3] = static_cast<uint8_t>(c1 >> 8);
+    out[4] = static_cast<uint8_t>(indices & 0xFF);
+    out[5] = static_cast<uint8_t>((indices >> 8) & 0xFF);
+    out[6] = static_cast<uint8_t>((indices >> 16) & 0xFF);
+    out[7] = static_cast<uint8_t>(indices >> 24);
+}
+
+void compressColourBlockRealtime(const uint8_t* block, uint8_t* out) {
+    uint8_t minColour[4], maxColour[4];
+    blockBounds(block, minColour, maxColour);
+    
+    // Inset the bounding box by 1/16 of its extent to reduce the error at the ends
+    for (int c = 0; c < 3; c++) {
+        int inset = (maxColour[c] - minColour[c]) >> 4;
+        minColour[c] = static_cast<uint8_t>(minColour[c] + inset);
+        maxColour[c] = static_cast<uint8_t>(maxColour[c] - inset);
+    }
+    
+    uint16_t c0 = packRGB565(maxColour);
+    uint16_t c1 = packRGB565(minColour);
+    if (c0 == c1) {
+        writeColourBlock(c0, c1, 0, out);
+        return;
+    }
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+    
+    int p0[3], p1[3];
+    unpackRGB565(c0, p0);
+    unpackRGB565(c1, p1);
+    writeColourBlock(c0, c1, selectIndices(block, p0, p1), out);
+}
+
+void compressAlphaBlockDXT3(const uint8_t* block, uint8_t* out) {
+    for (int i = 0; i < 8; i++) {
+        int a0 = (block[(i * 2) * 4 + 3] * 15 + 127) / 255;
+        int a1 = (block[(i * 2 + 1) * 4 + 3] * 15 + 127) / 255;
+        out[i] = static_cast<uint8_t>(a0 | (a1 << 4));
+    }
+}
+
+// Packs sixteen 3-bit DXT5 alpha indices after the two endpoints
+inline void writeAlphaIndicesDXT5(const uint8_t* indices, uint8_t* out) {
+    for (int group = 0; group < 2; group++) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 8; i++) {
+            bits |= static_cast<uint32_t>(indices[group * 8 + i]) << (3 * i);
+        }
+        out[2 + group * 3] = static_cast<uint8_t>(bits);
+        out[3 + group * 3] = static_cast<uint8_t>(bits >> 8);
+        out[4 + group * 3] = static_cast<uint8_t>(bits >> 16);
+    }
+}
+
+// Eight-value DXT5 alpha block spanning the block's alpha range
+void compressAlphaBlockDXT5(const uint8_t* block, uint8_t* out) {
+    int minAlpha = 255, maxAlpha = 0;
+    for (int i = 0; i < 16; i++) {
+        minAlpha = std::min(minAlpha, static_cast<int>(block[i * 4 + 3]));
+        maxAlpha = std::max(maxAlpha, static_cast<int>(block[i * 4 + 3]));
+    }
+    
+    uint8_t indices[16] = {};
+    if (maxAlpha > minAlpha) {
+        // Step t from minAlpha (0) to maxAlpha (7); alpha0 is index 0, alpha1 index 1,
+        // and indices 2..7 run from alpha0 towards alpha1
+        const int range = maxAlpha - minAlpha;
+        for (int i = 0; i < 16; i++) {
+            int t = ((block[i * 4 + 3] - minAlpha) * 7 + range / 2) / range;
+            indices[i] = static_cast<uint8_t>(t == 7 ? 0 : (t == 0 ? 1 : 8 - t));
+        }
+    }
+    out[0] = static_cast<uint8_t>(maxAlpha);
+    out[1] = static_cast<uint8_t>(minAlpha);
+    writeAlphaIndicesDXT5(indices, out);
+}
+
+// Encoded blocks keyed by their pixels, so repeated blocks skip the squish fit.
+// Solid blocks get their own table keyed by colour, which cannot be evicted by
+// the many distinct blocks of a detailed image. Direct-mapped: a collision
+// simply replaces the older entry.
+class BlockMemo {
+public:
+    explicit BlockMemo(size_t blockCount) {
+        size_t size = 16;
+        while (size < blockCount && size < kMaxEntries) {
+            size <<= 1;
+        }
+        entries.resize(size);
+    }
+    
+    struct Entry {
+        uint8_t pixels[64];
+        uint8_t encoded[16];
+        bool valid = false;
+    };
+    
+    // Slot for a full block; hit is true when it already holds these pixels
+    Entry& find(const uint8_t* pixels, bool& hit) {
+        uint32_t first;
+        std::memcpy(&first, pixels, 4);
+        bool solid = true;
+        for (int i = 1; i < 16 && solid; i++) {
+            solid = std::memcmp(pixels + i * 4, pixels, 4) == 0;
+        }
+        
+        Entry& entry = solid ? solidEntries[(first * 0x9E3779B1u) >> (32 - kSolidBits)]
+                             : entries[hashData(pixels, 64) & (entries.size() - 1)];
+        hit = entry.valid && std::memcmp(entry.pixels, pixels, 64) == 0;
+        return entry;
+    }
+    
+    static void fill(Entry& entry, const uint8_t* pixels, const uint8_t* encoded, size_t size) {
+        std::memcpy(entry.pixels, pixels, 64);
+        std::memcpy(entry.encoded, encoded, size);
+        entry.valid = true;
+    }
+    
+private:
+    static constexpr size_t kMaxEntries = 1024;
+    static constexpr int kSolidBits = 6;
+    std::vector<Entry> entries;
+    Entry solidEntries[1 << kSolidBits];
+};
+
+// Builds a 256-entry RGBA lookup table; indices past the palette map to entry 0
+inline void buildPaletteLUT(const uint8_t* palette, uint32_t paletteSize, uint32_t* lut) {
+    uint32_t count = std::min(paletteSize, 256u);
+    std::memcpy(lut, palette, count * 4);
+    for (uint32_t i = count; i < 256; i++) {
+        lut[i] = lut[0];
+    }
+}
+
+// Applies a thread count to OpenMP loops (ours and libimagequant's) for the
+// lifetime of the object. The OpenMP setting is per calling thread, so this does not leak
+// into other threads.
+class ScopedOpenMPThreads {
+public:
+    explicit ScopedOpenMPThreads(int threadCount) {
+#ifdef _OPENMP
+        previous = omp_get_max_threads();
+        if (threadCount > 0) {
+            omp_set_num_threads(threadCount);
+        }
+#else
+        (void)threadCount;
+#endif
+    }
+    
+    ~ScopedOpenMPThreads() {
+#ifdef _OPENMP
+        omp_set_num_threads(previous);
+#endif
+    }
+    
+    ScopedOpenMPThreads(const ScopedOpenMPThreads&) = delete;
+    ScopedOpenMPThreads& operator=(const ScopedOpenMPThreads&) = delete;
+    
+private:
+#ifdef _OPENMP
+    int previous;
+#endif
+};
+
+liq_attr* createQuantizerAttributes(uint32_t paletteSize, const PaletteOptions& options) {
+    liq_attr* attr = liq_attr_create();
+    if (!attr) {
+        return nullptr;
+    }
+    
+    if (liq_set_max_colors(attr, static_cast<int>(paletteSize)) != LIQ_OK ||
+        liq_set_speed(attr, std::clamp(options.speed, 1, 10)) != LIQ_OK ||
+        liq_set_quality(attr, options.minQuality, options.maxQuality) != LIQ_OK) {
+        liq_attr_destroy(attr);
+        return nullptr;
+    }
+    
+    return attr;
+}
+
+// Copies a libimagequant palette as RGBA, padded with zeroes to paletteSize entries
+void copyQuantizedPalette(const liq_palette* liqPalette, uint32_t paletteSize, std::vector<uint8_t>& palette) {
+    palette.clear();
+    palette.reserve(paletteSize * 4);
+    
+    for (unsigned int i = 0; i < liqPalette->count; i++) {
+        palette.push_back(liqPalette->entries[i].r);
+        palette.push_back(liqPalette->entries[i].g);
+        palette.push_back(liqPalette->entries[i].b);
+        palette.push_back(liqPalette->entries[i].a);
+    }
+    
+    // Pad palette to requested size if needed
+    palette.resize(paletteSize * 4, 0);
+}
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Windowed-sinc kernels for 2:1 decimation span three destination pixels either
+// side of the centre, which is twelve source taps: output i reads 2i-5 .. 2i+6
+constexpr int kDecimationTaps = 12;
+constexpr int kDecimationOffset = 5;
+
+double sinc(double x) {
+    if (std::fabs(x) < 1e-9) {
+        return 1.0;
+    }
+    x *= kPi;
+    return std::sin(x) / x;
+}
+
+// Modified Bessel function of the first kind, order zero (power series)
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x / 2.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+void buildDecimationKernel(MipmapFilter filter, float* weights) {
+    const double width = 3.0;
+    const double kaiserAlpha = 4.0;
+    double total = 0.0;
+    double w[kDecimationTaps];
+    
+    for (int k = 0; k < kDecimationTaps; k++) {
+        // Distance from the output centre in destination pixels
+        double x = ((k - kDecimationOffset) - 0.5) / 2.0;
+        if (filter == MipmapFilter::Lanczos) {
+            w[k] = sinc(x) * sinc(x / width);
+        } else {
+            double t = x / width;
+            double window = besselI0(kaiserAlpha * std::sqrt(std::max(0.0, 1.0 - t * t))) / besselI0(kaiserAlpha);
+            w[k] = sinc(x) * window;
+        }
+        total += w[k];
+    }
+    
+    for (int k = 0; k < kDecimationTaps; k++) {
+        weights[k] = static_cast<float>(w[k] / total);
+    }
+}
+
+// sRGB transfer tables for gamma-correct filtering. Linear values use 14 bits
+// so that a 2x2 box sum still fits an unsigned 16-bit lane.
+constexpr int kLinearBits = 14;
+constexpr int kLinearMax = (1 << kLinearBits) - 1;
+
+struct GammaTables {
+    float toLinear[256];                   // sRGB8 -> linear, scaled to 0..255
+    uint16_t toLinear14[256];              // sRGB8 -> linear, 0..kLinearMax
+    uint8_t fromLinear14[kLinearMax + 1];  // linear -> sRGB8, rounded
+};
+
+GammaTables buildGammaTables() {
+    GammaTables tables;
+    for (int i = 0; i < 256; i++) {
+        double s = i / 255.0;
+        double linear = s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+        tables.toLinear[i] = static_cast<float>(linear * 255.0);
+        tables.toLinear14[i] = static_cast<uint16_t>(std::lround(linear * kLinearMax));
+    }
+    for (int i = 0; i <= kLinearMax; i++) {
+        double linear = static_cast<double>(i) / kLinearMax;
+        double s = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+        tables.fromLinear14[i] = static_cast<uint8_t>(std::clamp(std::lround(s * 255.0), 0L, 255L));
+    }
+    return tables;
+}
+
+const GammaTables& gammaTables() {
+    static const GammaTables tables = buildGammaTables();
+    return tables;
+}
+
+// Linear 0..255 float back to sRGB8 through the 14-bit inverse table
+inline uint8_t linearToSRGB(const GammaTables& tables, float linear) {
+    int index = static_cast<int>(linear * (kLinearMax / 255.0f) + 0.5f);
+    return tables.fromLinear14[std::clamp(index, 0, kLinearMax)];
+}
+
+// Converts an RGBA8 row to 14-bit linear RGB; alpha is kept linear as a * 64
+void linearizeRow(const GammaTables& tables, const uint8_t* row, uint32_t width, uint16_t* out) {
+    for (uint32_t x = 0; x < width; x++) {
+        out[x * 4 + 0] = tables.toLinear14[row[x * 4 + 0]];
+        out[x * 4 + 1] = tables.toLinear14[row[x * 4 + 1]];
+        out[x * 4 + 2] = tables.toLinear14[row[x * 4 + 2]];
+        out[x * 4 + 3] = static_cast<uint16_t>(row[x * 4 + 3] << 6);
+    }
+}
+
+// Resolves a 2x2 sum of linearised pixels to sRGB8
+inline void storeLinearSum(const GammaTables& tables, const uint16_t* sum, uint8_t* out) {
+    for (int c = 0; c < 3; c++) {
+        out[c] = tables.fromLinear14[(sum[c] + 2) >> 2];
+    }
+    out[3] = static_cast<uint8_t>((sum[3] + 128) >> 8);
+}
+
+void downsampleBoxGamma(const uint8_t* src, uint32_t sw, uint32_t sh, uint8_t* dst, uint32_t dw, uint32_t dh) {
+    const GammaTables& tables = gammaTables();
+    std::vector<uint16_t> lin0(static_cast<size_t>(sw) * 4);
+    std::vector<uint16_t> lin1(static_cast<size_t>(sw) * 4);
+    
+    for (uint32_t y = 0; y < dh; y++) {
+        uint32_t y0 = std::min(2 * y, sh - 1);
+        uint32_t y1 = std::min(2 * y + 1, sh - 1);
+        linearizeRow(tables, src + static_cast<size_t>(y0) * sw * 4, sw, lin0.data());
+        linearizeRow(tables, src + static_cast<size_t>(y1) * sw * 4, sw, lin1.data());
+        uint8_t* out = dst + static_cast<size_t>(y) * dw * 4;
+        uint32_t x = 0;
+        
+#ifdef LIBTXD_USE_SSE2
+        // Two output pixels per iteration; four 14-bit values sum within 16 bits
+        alignas(16) uint16_t sums[8];
+        for (; x + 2 <= dw && 2 * x + 4 <= sw; x += 2) {
+            const __m128i* r0 = reinterpret_cast<const __m128i*>(lin0.data() + x * 8);
+            const __m128i* r1 = reinterpret_cast<const __m128i*>(lin1.data() + x * 8);
+            __m128i lo = _mm_add_epi16(_mm_loadu_si128(r0), _mm_loadu_si128(r1));
+            __m128i hi = _mm_add_epi16(_mm_loadu_si128(r0 + 1), _mm_loadu_si128(r1 + 1));
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            _mm_store_si128(reinterpret_cast<__m128i*>(sums), _mm_unpacklo_epi64(lo, hi));
+            storeLinearSum(tables, sums, out + x * 4);
+            storeLinearSum(tables, sums + 4, out + x * 4 + 4);
+        }
+#endif
+        
+        for (; x < dw; x++) {
+            uint32_t x0 = std::min(2 * x, sw - 1);
+            uint32_t x1 = std::min(2 * x + 1, sw - 1);
+            uint16_t sum[4];
+            for (int c = 0; c < 4; c++) {
+                sum[c] = static_cast<uint16_t>(lin0[x0 * 4 + c] + lin0[x1 * 4 + c] + lin1[x0 * 4 + c] + lin1[x1 * 4 + c]);
+            }
+            storeLinearSum(tables, sum, out + x * 4);
+        }
+    }
+}
+
+void downsampleBox(const uint8_t* src, uint32_t sw, uint32_t sh, uint8_t* dst, uint32_t dw, uint32_t dh) {
+    for (uint32_t y = 0; y < dh; y++) {
+        const uint8_t* row0 = src + static_cast<size_t>(std::min(2 * y, sh - 1)) * sw * 4;
+        const uint8_t* row1 = src + static_cast<size_t>(std::min(2 * y + 1, sh - 1)) * sw * 4;
+        uint8_t* out = dst + static_cast<size_t>(y) * dw * 4;
+        uint32_t x = 0;
+        
+#ifdef LIBTXD_USE_SSE2
+        // Two output pixels from four source pixels of each row per iteration
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; x + 2 <= dw && 2 * x + 4 <= sw; x += 2) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            __m128i sum = _mm_unpacklo_epi64(lo, hi);
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, sum));
+        }
+#endif
+        
+        for (; x < dw; x++) {
+            uint32_t x0 = std::min(2 * x, sw - 1);
+            uint32_t x1 = std::min(2 * x + 1, sw - 1);
+            for (int c = 0; c < 4; c++) {
+                int sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+                out[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+// Accumulates weighted float RGBA pixels: acc += weight * pixel
+inline void accumulatePixel(float* acc, const float* pixel, float weight) {
+#ifdef LIBTXD_USE_SSE2
+    _mm_storeu_ps(acc, _mm_add_ps(_mm_loadu_ps(acc), _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(weight))));
+#else
+    for (int c = 0; c < 4; c++) {
+        acc[c] += pixel[c] * weight;
+    }
+#endif
+}
+
+// Rounds and clamps a float RGBA pixel to 8 bits per channel
+inline void storePixel(const float* pixel, uint8_t* out) {
+#ifdef LIBTXD_USE_SSE2
+    __m128i v = _mm_cvtps_epi32(_mm_loadu_ps(pixel));
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+    std::memcpy(out, &packed, 4);
+#else
+    for (int c = 0; c < 4; c++) {
+        float value = std::floor(pixel[c] + 0.5f);
+        out[c] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+    }
+#endif
+}
+
+void downsampleFiltered(const uint8_t* src, uint32_t sw, uint32_t sh, MipmapFilter filter,
+                        uint8_t* dst, uint32_t dw, uint32_t dh, bool gammaCorrect) {
+    const GammaTables* tables = gammaCorrect ? &gammaTables() : nullptr;
+    float kernel[kDecimationTaps];
+    buildDecimationKernel(filter, kernel);
+    
+    const bool scaleX = dw < sw;
+    const bool scaleY = dh < sh;
+    
+    // Horizontal pass into a float buffer of dw x sh pixels
+    std::vector<float> rowFloat(static_cast<size_t>(sw) * 4);
+    std::vector<float> temp(static_cast<size_t>(dw) * sh * 4);
+    for (uint32_t y = 0; y < sh; y++) {
+        const uint8_t* row = src + static_cast<size_t>(y) * sw * 4;
+        if (tables) {
+            for (uint32_t x = 0; x < sw; x++) {
+                rowFloat[x * 4 + 0] = tables->toLinear[row[x * 4 + 0]];
+                rowFloat[x * 4 + 1] = tables->toLinear[row[x * 4 + 1]];
+                rowFloat[x * 4 + 2] = tables->toLinear[row[x * 4 + 2]];
+                rowFloat[x * 4 + 3] = row[x * 4 + 3];
+            }
+        } else {
+            for (size_t i = 0; i < rowFloat.size(); i++) {
+                rowFloat[i] = row[i];
+            }
+        }
+        
+        float* out = temp.data() + static_cast<size_t>(y) * dw * 4;
+        for (uint32_t x = 0; x < dw; x++) {
+            float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            if (scaleX) {
+                for (int k = 0; k < kDecimationTaps; k++) {
+                    int sx = std::clamp(static_cast<int>(2 * x) + k - kDecimationOffset, 0, static_cast<int>(sw) - 1);
+                    accumulatePixel(acc, rowFloat.data() + sx * 4, kernel[k]);
+                }
+            } else {
+                accumulatePixel(acc, rowFloat.data() + x * 4, 1.0f);
+            }
+            std::memcpy(out + x * 4, acc, sizeof(acc));
+        }
+    }
+    
+    // Vertical pass
+    for (uint32_t y = 0; y < dh; y++) {
+        uint8_t* out = dst + static_cast<size_t>(y) * dw * 4;
+        for (uint32_t x = 0; x < dw; x++) {
+            float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            if (scaleY) {
+                for (int k = 0; k < kDecimationTaps; k++) {
+                    int sy = std::clamp(static_cast<int>(2 * y) + k - kDecimationOffset, 0, static_cast<int>(sh) - 1);
+                    accumulatePixel(acc, temp.data() + (static_cast<size_t>(sy) * dw + x) * 4, kernel[k]);
+                }
+            } else {
+                accumulatePixel(acc, temp.data() + (static_cast<size_t>(y) * dw + x) * 4, 1.0f);
+            }
+            storePixel(acc, out + x * 4);
+            if (tables) {
+                for (int c = 0; c < 3; c++) {
+                    out[x * 4 + c] = linearToSRGB(*tables, acc[c]);
+                }
+            }
+        }
+    }
+}
+
+// Polyphase weights for resampling one axis from srcSize to dstSize pixels.
+// Output i reads taps source pixels from first[i]; edge taps are folded onto
+// the border pixels, so every index is in range.
+struct ResampleWeights {
+    uint32_t taps;
+    std::vector<uint32_t> first;
+    std::vector<float> weights;  // dstSize * taps
+};
+
+double resizeFilterRadius(ResizeFilter filter) {
+    switch (filter) {
+        case ResizeFilter::Box: return 0.5;
+        case ResizeFilter::Bilinear: return 1.0;
+        case ResizeFilter::Bicubic: return 2.0;
+        default: return 3.0;
+    }
+}
+
+double resizeFilterWeight(ResizeFilter filter, double x) {
+    double ax = std::abs(x);
+    switch (filter) {
+        case ResizeFilter::Box:
+            return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+        case ResizeFilter::Bilinear:
+            return std::max(0.0, 1.0 - ax);
+        case ResizeFilter::Bicubic:
+            // Catmull-Rom (a = -0.5)
+            if (ax < 1.0) {
+                return (1.5 * ax - 2.5) * ax * ax + 1.0;
+            }
+            if (ax < 2.0) {
+                return ((-0.5 * ax + 2.5) * ax - 4.0) * ax + 2.0;
+            }
+            return 0.0;
+        default:
+            return ax < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+    }
+}
+
+ResampleWeights buildResampleWeights(uint32_t srcSize, uint32_t dstSize, ResizeFilter filter) {
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    // Widen the kernel when shrinking so it covers every source pixel
+    const double filterScale = std::max(1.0, scale);
+    const double support = resizeFilterRadius(filter) * filterScale;
+    
+    ResampleWeights result;
+    result.taps = std::min(srcSize, static_cast<uint32_t>(std::ceil(support * 2.0)) + 1);
+    result.first.resize(dstSize);
+    result.weights.assign(static_cast<size_t>(dstSize) * result.taps, 0.0f);
+    
+    std::vector<double> w(result.taps);
+    for (uint32_t i = 0; i < dstSize; i++) {
+        const double centre = (i + 0.5) * scale - 0.5;
+        const int64_t left = static_cast<int64_t>(std::ceil(centre - support));
+        const int64_t right = static_cast<int64_t>(std::floor(centre + support));
+        const int64_t last = static_cast<int64_t>(srcSize) - 1;
+        uint32_t first = static_cast<uint32_t>(std::clamp<int64_t>(left, 0, last));
+        first = std::min(first, srcSize - result.taps);
+        
+        std::fill(w.begin(), w.end(), 0.0);
+        double total = 0.0;
+        for (int64_t j = left; j <= right; j++) {
+            double weight = resizeFilterWeight(filter, (j - centre) / filterScale);
+            int64_t index = std::clamp<int64_t>(j, 0, last) - first;
+            if (weight != 0.0 && index >= 0 && index < static_cast<int64_t>(result.taps)) {
+                w[static_cast<size_t>(index)] += weight;
+                total += weight;
+            }
+        }
+        if (total == 0.0) {
+            // Box upsampling can miss every centre by rounding; use the nearest pixel
+            uint32_t nearest = static_cast<uint32_t>(std::clamp<int64_t>(std::llround(centre), 0, last));
+            w[nearest - first] = 1.0;
+            total = 1.0;
+        }
+        
+        result.first[i] = first;
+        float* out = result.weights.data() + static_cast<size_t>(i) * result.taps;
+        for (uint32_t k = 0; k < result.taps; k++) {
+            out[k] = static_cast<float>(w[k] / total);
+        }
+    }
+    return result;
+}
+
+// Recently used weight tables; batch resizes reuse the same few sizes
+std::shared_ptr<const ResampleWeights> cachedResampleWeights(uint32_t srcSize, uint32_t dstSize, ResizeFilter filter) {
+    struct Entry {
+        uint32_t srcSize;
+        uint32_t dstSize;
+        ResizeFilter filter;
+        std::shared_ptr<const ResampleWeights> weights;
+    };
+    static std::mutex mutex;
+    static std::vector<Entry> entries;
+    const size_t maxEntries = 32;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : entries) {
+            if (entry.srcSize == srcSize && entry.dstSize == dstSize && entry.filter == filter) {
+                return entry.weights;
+            }
+        }
+    }
+    
+    auto weights = std::make_shared<const ResampleWeights>(buildResampleWeights(srcSize, dstSize, filter));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.size() >= maxEntries) {
+        entries.erase(entries.begin());
+    }
+    entries.push_back({srcSize, dstSize, filter, weights});
+    return weights;
+}
+
+// acc[i] += weight * row[i] over count floats
+inline void accumulateRow(float* acc, const float* row, float weight, size_t count) {
+    size_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+    const __m128 w = _mm_set1_ps(weight);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a0 = _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(_mm_loadu_ps(row + i), w));
+        __m128 a1 = _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(_mm_loadu_ps(row + i + 4), w));
+        _mm_storeu_ps(acc + i, a0);
+        _mm_storeu_ps(acc + i + 4, a1);
+    }
+#endif
+    for (; i < count; i++) {
+        acc[i] += row[i] * weight;
+    }
+}
+
+// With weightByAlpha colour is filtered premultiplied, so RGB under transparent
+// pixels does not bleed into visible ones. Outputs that end up transparent are black.
+void resizeSeparable(const uint8_t* src, uint32_t sw, uint32_t sh, uint8_t* dst, uint32_t dw, uint32_t dh,
+                     ResizeFilter filter, bool gammaCorrect, bool weightByAlpha) {
+    const GammaTables* tables = gammaCorrect ? &gammaTables() : nullptr;
+    auto weightsX = cachedResampleWeights(sw, dw, filter);
+    auto weightsY = cachedResampleWeights(sh, dh, filter);
+    
+    // Horizontal pass into a float buffer of dw x sh pixels
+    std::vector<float> temp(static_cast<size_t>(dw) * sh * 4);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (static_cast<size_t>(dw) * sh > 65536)
+#endif
+    for (int64_t y = 0; y < static_cast<int64_t>(sh); y++) {
+        std::vector<float> rowFloat(static_cast<size_t>(sw) * 4);
+        const uint8_t* row = src + static_cast<size_t>(y) * sw * 4;
+        if (tables) {
+            for (uint32_t x = 0; x < sw; x++) {
+                rowFloat[x * 4 + 0] = tables->toLinear[row[x * 4 + 0]];
+                rowFloat[x * 4 + 1] = tables->toLinear[row[x * 4 + 1]];
+                rowFloat[x * 4 + 2] = tables->toLinear[row[x * 4 + 2]];
+                rowFloat[x * 4 + 3] = row[x * 4 + 3];
+            }
+        } else {
+            for (size_t i = 0; i < rowFloat.size(); i++) {
+                rowFloat[i] = row[i];
+            }
+        }
+        if (weightByAlpha) {
+            for (uint32_t x = 0; x < sw; x++) {
+                float a = rowFloat[x * 4 + 3] * (1.0f / 255.0f);
+                rowFloat[x * 4 + 0] *= a;
+                rowFloat[x * 4 + 1] *= a;
+                rowFloat[x * 4 + 2] *= a;
+            }
+        }
+        
+        float* out = temp.data() + static_cast<size_t>(y) * dw * 4;
+        for (uint32_t x = 0; x < dw; x++) {
+            const float* w = weightsX->weights.data() + static_cast<size_t>(x) * weightsX->taps;
+            const float* in = rowFloat.data() + static_cast<size_t>(weightsX->first[x]) * 4;
+            float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (uint32_t k = 0; k < weightsX->taps; k++) {
+                accumulatePixel(acc, in + k * 4, w[k]);
+            }
+            std::memcpy(out + x * 4, acc, sizeof(acc));
+        }
+    }
+    
+    // Vertical pass, a whole row at a time
+    const size_t rowFloats = static_cast<size_t>(dw) * 4;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (static_cast<size_t>(dw) * dh > 65536)
+#endif
+    for (int64_t y = 0; y < static_cast<int64_t>(dh); y++) {
+        std::vector<float> acc(rowFloats, 0.0f);
+        const float* w = weightsY->weights.data() + static_cast<size_t>(y) * weightsY->taps;
+        for (uint32_t k = 0; k < weightsY->taps; k++) {
+            if (w[k] != 0.0f) {
+                accumulateRow(acc.data(), temp.data() + (weightsY->first[y] + k) * rowFloats, w[k], rowFloats);
+            }
+        }
+        
+        uint8_t* out = dst + static_cast<size_t>(y) * dw * 4;
+        for (uint32_t x = 0; x < dw; x++) {
+            if (weightByAlpha) {
+                // Alpha that rounds to zero carries no usable colour
+                float a = acc[x * 4 + 3];
+                float scale = a >= 0.5f ? 255.0f / a : 0.0f;
+                acc[x * 4 + 0] *= scale;
+                acc[x * 4 + 1] *= scale;
+                acc[x * 4 + 2] *= scale;
+            }
+            storePixel(acc.data() + x * 4, out + x * 4);
+            if (tables) {
+                for (int c = 0; c < 3; c++) {
+                    out[x * 4 + c] = linearToSRGB(*tables, acc[x * 4 + c]);
+                }
+            }
+        }
+    }
+}
+
+inline bool blockHasTransparency(const uint8_t* block) {
+    for (int i = 0; i < 16; i++) {
+        if (block[i * 4 + 3] < 128) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Layout of the 16-bit raster formats. Channels are quantised to 0..levels and
+// combined as sum(q * multiplier); bit 15 uses -32768, which wraps to 0x8000.
+struct PackedFormat {
+    int16_t levels[4];      // RGBA, 0 when the channel is not stored
+    int16_t multiplier[4];
+};
+
+bool getPackedFormat(uint32_t baseFormat, PackedFormat& packed) {
+    switch (baseFormat) {
+        case static_cast<uint32_t>(RasterFormat::R5G6B5):
+            packed = { { 31, 63, 31, 0 }, { 2048, 32, 1, 0 } };
+            return true;
+        case static_cast<uint32_t>(RasterFormat::A1R5G5B5):
+            packed = { { 31, 31, 31, 1 }, { 1024, 32, 1, -32768 } };
+            return true;
+        case static_cast<uint32_t>(RasterFormat::R4G4B4A4):
+            packed = { { 15, 15, 15, 15 }, { 256, 16, 1, 4096 } };
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Bias added before truncating v * levels / 255: 127 rounds to nearest, the
+// Bayer thresholds spread the rounding point over a 4x4 tile
+constexpr int kRoundingBias = 127;
+constexpr uint8_t kBayer4[4][4] = {
+    { 0, 8, 2, 10 },
+    { 12, 4, 14, 6 },
+    { 3, 11, 1, 9 },
+    { 15, 7, 13, 5 }
+};
+
+inline int orderedBias(uint32_t x, uint32_t y) {
+    return kBayer4[y & 3][x & 3] * 16 + 8;
+}
+
+// floor(x / 255) for 0 <= x < 65535
+inline int divide255(int x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+inline void storePacked16(uint8_t* out, int value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void encodePackedRow(const uint8_t* src, uint32_t width, uint32_t y, const PackedFormat& packed,
+                     bool ordered, uint8_t* out) {
+    uint32_t x = 0;
+    
+#ifdef LIBTXD_USE_SSE2
+    // Four pixels per iteration. x stays a multiple of 4, so the Bayer biases
+    // of a row are loop invariant.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i levels = _mm_setr_epi16(packed.levels[0], packed.levels[1], packed.levels[2], packed.levels[3],
+                                          packed.levels[0], packed.levels[1], packed.levels[2], packed.levels[3]);
+    const __m128i multipliers = _mm_setr_epi16(packed.multiplier[0], packed.multiplier[1],
+                                               packed.multiplier[2], packed.multiplier[3],
+                                               packed.multiplier[0], packed.multiplier[1],
+                                               packed.multiplier[2], packed.multiplier[3]);
+    int16_t bias[4];
+    for (int i = 0; i < 4; i++) {
+        bias[i] = static_cast<int16_t>(ordered ? orderedBias(i, y) : kRoundingBias);
+    }
+    const __m128i biasLo = _mm_setr_epi16(bias[0], bias[0], bias[0], bias[0], bias[1], bias[1], bias[1], bias[1]);
+    const __m128i biasHi = _mm_setr_epi16(bias[2], bias[2], bias[2], bias[2], bias[3], bias[3], bias[3], bias[3]);
+    
+    auto packPair = [&](__m128i pixels, __m128i pairBias) {
+        __m128i v = _mm_add_epi16(_mm_mullo_epi16(pixels, levels), pairBias);
+        __m128i q = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(v, one), _mm_srli_epi16(v, 8)), 8);
+        __m128i sums = _mm_madd_epi16(q, multipliers);
+        sums = _mm_add_epi32(sums, _mm_srli_epi64(sums, 32));
+        return _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 1, 2, 0));
+    };
+    
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        __m128i lo = packPair(_mm_unpacklo_epi8(pixels, zero), biasLo);
+        __m128i hi = packPair(_mm_unpackhi_epi8(pixels, zero), biasHi);
+        __m128i values = _mm_unpacklo_epi64(lo, hi);
+        // Sign-extend the low 16 bits so the saturating pack keeps them intact
+        values = _mm_srai_epi32(_mm_slli_epi32(values, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 2), _mm_packs_epi32(values, values));
+    }
+#endif
+    
+    for (; x < width; x++) {
+        int bias = ordered ? orderedBias(x, y) : kRoundingBias;
+        int value = 0;
+        for (int c = 0; c < 4; c++) {
+            value += divide255(src[x * 4 + c] * packed.levels[c] + bias) * packed.multiplier[c];
+        }
+        storePacked16(out + x * 2, value);
+    }
+}
+
+// Floyd-Steinberg error diffusion into a 16-bit format
+void encodePackedDiffused(const uint8_t* src, uint32_t width, uint32_t height, const PackedFormat& packed,
+                          uint8_t* out) {
+    // One pixel of padding on each side of both error rows
+    std::vector<float> current((width + 2) * 4, 0.0f);
+    std::vector<float> next((width + 2) * 4, 0.0f);
+    
+    for (uint32_t y = 0; y < height; y++) {
+        std::fill(next.begin(), next.end(), 0.0f);
+        const uint8_t* row = src + static_cast<size_t>(y) * width * 4;
+        
+        for (uint32_t x = 0; x < width; x++) {
+            int value = 0;
+            for (int c = 0; c < 4; c++) {
+                int levels = packed.levels[c];
+                if (levels == 0) {
+                    continue;
+                }
+                size_t e = (x + 1) * 4 + c;
+                float wanted = std::clamp(row[x * 4 + c] + current[e], 0.0f, 255.0f);
+                int q = std::clamp(static_cast<int>(wanted * levels / 255.0f + 0.5f), 0, levels);
+                float error = wanted - static_cast<float>((q * 255 + levels / 2) / levels);
+                
+                current[e + 4] += error * (7.0f / 16.0f);
+                next[e - 4] += error * (3.0f / 16.0f);
+                next[e] += error * (5.0f / 16.0f);
+                next[e + 4] += error * (1.0f / 16.0f);
+                value += q * packed.multiplier[c];
+            }
+            storePacked16(out + (static_cast<size_t>(y) * width + x) * 2, value);
+        }
+        current.swap(next);
+    }
+}
+
+// Rec. 601 luma, 8 bits
+void encodeLuminanceRow(const uint8_t* src, uint32_t width, uint8_t* out) {
+    uint32_t x = 0;
+    
+#ifdef LIBTXD_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_setr_epi16(77, 150, 29, 0, 77, 150, 29, 0);
+    const __m128i rounding = _mm_set1_epi32(128);
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+        lo = _mm_shuffle_epi32(_mm_add_epi32(lo, _mm_srli_epi64(lo, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+        hi = _mm_shuffle_epi32(_mm_add_epi32(hi, _mm_srli_epi64(hi, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i luma = _mm_srli_epi32(_mm_add_epi32(_mm_unpacklo_epi64(lo, hi), rounding), 8);
+        luma = _mm_packs_epi32(luma, luma);
+        luma = _mm_packus_epi16(luma, luma);
+        uint32_t packedLuma = static_cast<uint32_t>(_mm_cvtsi128_si32(luma));
+        std::memcpy(out + x, &packedLuma, 4);
+    }
+#endif
+    
+    for (; x < width; x++) {
+        const uint8_t* px = src + x * 4;
+        out[x] = static_cast<uint8_t>((px[0] * 77 + px[1] * 150 + px[2] * 29 + 128) >> 8);
+    }
+}
+
+// Block-level DXT transcoding. DXT3 and DXT5 blocks are 8 bytes of alpha
+// (explicit 4-bit values, or two endpoints and 3-bit indices) followed by a colour
+// block that always decodes in four-colour mode; a DXT1 colour block decodes in
+// three-colour-plus-transparent mode when colour0 <= colour1.
+
+inline uint16_t readColour(const uint8_t* block, int index) {
+    return static_cast<uint16_t>(block[index * 2] | (block[index * 2 + 1] << 8));
+}
+
+inline uint32_t readIndices(const uint8_t* block) {
+    return static_cast<uint32_t>(block[4]) | (static_cast<uint32_t>(block[5]) << 8) |
+           (static_cast<uint32_t>(block[6]) << 16) | (static_cast<uint32_t>(block[7]) << 24);
+}
+
+inline void writeColourBlockRaw(uint8_t* block, uint16_t c0, uint16_t c1, uint32_t indices) {
+    block[0] = static_cast<uint8_t>(c0);
+    block[1] = static_cast<uint8_t>(c0 >> 8);
+    block[2] = static_cast<uint8_t>(c1);
+    block[3] = static_cast<uint8_t>(c1 >> 8);
+    for (int i = 0; i < 4; i++) {
+        block[4 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+}
+
+inline bool alphaBlockOpaque(const uint8_t* alpha) {
+    uint64_t bits;
+    std::memcpy(&bits, alpha, 8);
+    return bits == ~0ULL;
+}
+
+inline bool alphaBlockOpaqueDXT5(const uint8_t* alpha) {
+    if (alpha[0] == 255 && alpha[1] == 255) {
+        return true;
+    }
+    // Only indices that select an endpoint of 255 (or the 255 of six-value mode) decode to 255
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) {
+        bits |= static_cast<uint64_t>(alpha[2 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 16; i++) {
+        uint32_t index = (bits >> (3 * i)) & 7;
+        bool opaque = (index == 0 && alpha[0] == 255) || (index == 1 && alpha[1] == 255) ||
+                      (index == 7 && alpha[0] <= alpha[1]);
+        if (!opaque) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// DXT5 alpha block reproducing a DXT3 alpha block whose values are all 0x0 or 0xF
+void binaryAlphaToDXT5(const uint8_t* alpha, uint8_t* out) {
+    uint8_t indices[16];
+    for (int i = 0; i < 16; i++) {
+        indices[i] = ((alpha[i / 2] >> (4 * (i & 1))) & 0xF) ? 0 : 1;
+    }
+    out[0] = 255;
+    out[1] = 0;
+    writeAlphaIndicesDXT5(indices, out);
+}
+
+// Four-colour colour block (DXT3/DXT5) to a DXT1 block with identical decoding
+void transcodeColourToDXT1(const uint8_t* src, uint8_t* dst) {
+    uint16_t c0 = readColour(src, 0);
+    uint16_t c1 = readColour(src, 1);
+    uint32_t indices = readIndices(src);
+    
+    if (c0 > c1) {
+        std::memcpy(dst, src, 8);
+    } else if (c0 < c1) {
+        // Swapping the endpoints swaps indices 0/1 and 2/3
+        writeColourBlockRaw(dst, c1, c0, indices ^ 0x55555555u);
+    } else {
+        // Every index decodes to the single colour; index 3 would be transparent in DXT1
+        writeColourBlockRaw(dst, c0, c1, 0);
+    }
+}
+
+// DXT1 block to DXT3. Returns false if the block needs re-encoding.
+bool transcodeBlockToDXT3(const uint8_t* src, uint8_t* dst) {
+    uint16_t c0 = readColour(src, 0);
+    uint16_t c1 = readColour(src, 1);
+    uint32_t indices = readIndices(src);
+    
+    uint64_t alpha = ~0ULL;
+    if (c0 <= c1) {
+        for (int i = 0; i < 16; i++) {
+            uint32_t index = (indices >> (2 * i)) & 3;
+            if (index == 2) {
+                return false;
+            }
+            if (index == 3) {
+                // Transparent black: clear the alpha and point at an endpoint
+                alpha &= ~(0xFULL << (4 * i));
+                indices &= ~(3u << (2 * i));
+            }
+        }
+    }
+    
+    for (int i = 0; i < 8; i++) {
+        dst[i] = static_cast<uint8_t>(alpha >> (8 * i));
+    }
+    writeColourBlockRaw(dst + 8, c0, c1, indices);
+    return true;
+}
+
+// Sums of squared differences and maximum absolute differences per channel
+void accumulateErrors(const uint8_t* a, const uint8_t* b, size_t pixelCount, uint64_t* sumSquared, uint8_t* maxError) {
+    for (int c = 0; c < 4; c++) {
+        sumSquared[c] = 0;
+        maxError[c] = 0;
+    }
+    size_t i = 0;
+    
+#ifdef LIBTXD_USE_SSE2
+    // Four pixels per iteration into 32-bit lanes, flushed before they can overflow
+    const __m128i zero = _mm_setzero_si128();
+    const size_t kFlushInterval = 8192;
+    __m128i maxBytes = zero;
+    while (i + 4 <= pixelCount) {
+        __m128i sums = zero;
+        size_t end = std::min(pixelCount & ~static_cast<size_t>(3), i + kFlushInterval * 4);
+        for (; i < end; i += 4) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i * 4));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i * 4));
+            __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            maxBytes = _mm_max_epu8(maxBytes, diff);
+            
+            __m128i lo = _mm_unpacklo_epi8(diff, zero);
+            __m128i hi = _mm_unpackhi_epi8(diff, zero);
+            lo = _mm_mullo_epi16(lo, lo);
+            hi = _mm_mullo_epi16(hi, hi);
+            sums = _mm_add_epi32(sums, _mm_unpacklo_epi16(lo, zero));
+            sums = _mm_add_epi32(sums, _mm_unpackhi_epi16(lo, zero));
+            sums = _mm_add_epi32(sums, _mm_unpacklo_epi16(hi, zero));
+            sums = _mm_add_epi32(sums, _mm_unpackhi_epi16(hi, zero));
+        }
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sums);
+        for (int c = 0; c < 4; c++) {
+            sumSquared[c] += lanes[c];
+        }
+    }
+    alignas(16) uint8_t maxLanes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxLanes), maxBytes);
+    for (int k = 0; k < 16; k++) {
+        maxError[k & 3] = std::max(maxError[k & 3], maxLanes[k]);
+    }
+#endif
+    
+    for (; i < pixelCount; i++) {
+        for (int c = 0; c < 4; c++) {
+            int diff = std::abs(static_cast<int>(a[i * 4 + c]) - b[i * 4 + c]);
+            sumSquared[c] += static_cast<uint64_t>(diff * diff);
+            maxError[c] = std::max(maxError[c], static_cast<uint8_t>(diff));
+        }
+    }
+}
+
+inline double psnrFromMse(double mse) {
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+}
+
+// Mean SSIM of two single-channel float planes over 8x8 windows at stride 4
+double meanSSIM(const float* x, const float* y, uint32_t width, uint32_t height) {
+    const double c1 = (0.01 * 255.0) * (0.01 * 255.0);
+    const double c2 = (0.03 * 255.0) * (0.03 * 255.0);
+    const uint32_t windowW = std::min(8u, width);
+    const uint32_t windowH = std::min(8u, height);
+    
+    double total = 0.0;
+    size_t windows = 0;
+    for (uint32_t wy = 0; wy + windowH <= height; wy += 4) {
+        for (uint32_t wx = 0; wx + windowW <= width; wx += 4) {
+            float sums[5] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };  // x, y, xx, yy, xy
+            for (uint32_t j = 0; j < windowH; j++) {
+                const float* rx = x + static_cast<size_t>(wy + j) * width + wx;
+                const float* ry = y + static_cast<size_t>(wy + j) * width + wx;
+                uint32_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+                __m128 sx = _mm_setzero_ps(), sy = _mm_setzero_ps();
+                __m128 sxx = _mm_setzero_ps(), syy = _mm_setzero_ps(), sxy = _mm_setzero_ps();
+                for (; i + 4 <= windowW; i += 4) {
+                    __m128 vx = _mm_loadu_ps(rx + i);
+                    __m128 vy = _mm_loadu_ps(ry + i);
+                    sx = _mm_add_ps(sx, vx);
+                    sy = _mm_add_ps(sy, vy);
+                    sxx = _mm_add_ps(sxx, _mm_mul_ps(vx, vx));
+                    syy = _mm_add_ps(syy, _mm_mul_ps(vy, vy));
+                    sxy = _mm_add_ps(sxy, _mm_mul_ps(vx, vy));
+                }
+                alignas(16) float lanes[5][4];
+                _mm_store_ps(lanes[0], sx);
+                _mm_store_ps(lanes[1], sy);
+                _mm_store_ps(lanes[2], sxx);
+                _mm_store_ps(lanes[3], syy);
+                _mm_store_ps(lanes[4], sxy);
+                for (int k = 0; k < 5; k++) {
+                    sums[k] += lanes[k][0] + lanes[k][1] + lanes[k][2] + lanes[k][3];
+                }
+#endif
+                for (; i < windowW; i++) {
+                    sums[0] += rx[i];
+                    sums[1] += ry[i];
+                    sums[2] += rx[i] * rx[i];
+                    sums[3] += ry[i] * ry[i];
+                    sums[4] += rx[i] * ry[i];
+                }
+            }
+            
+            double n = static_cast<double>(windowW) * windowH;
+            double mx = sums[0] / n;
+            double my = sums[1] / n;
+            double vx = std::max(0.0, sums[2] / n - mx * mx);
+            double vy = std::max(0.0, sums[3] / n - my * my);
+            double cov = sums[4] / n - mx * my;
+            total += ((2.0 * mx * my + c1) * (2.0 * cov + c2)) / ((mx * mx + my * my + c1) * (vx + vy + c2));
+            windows++;
+        }
+    }
+    return windows > 0 ? total / windows : 1.0;
+}
+
+std::mutex cacheMutex;
+std::shared_ptr<CompressionCache> activeCache;
+
+std::shared_ptr<CompressionCache> currentCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return activeCache;
+}
+
+CacheKey makeDXTCacheKey(const uint8_t* rgba, uint32_t width, uint32_t height,
+                         Compression compression, const CompressionProfile& profile) {
+    CacheKey key;
+    key.pixelHash = hashData(rgba, static_cast<size_t>(width) * height * 4);
+    key.width = width;
+    key.height = height;
+    key.format = static_cast<uint32_t>(compression);
+    uint8_t settings[4] = {
+        static_cast<uint8_t>(profile.speed),
+        static_cast<uint8_t>(profile.perceptualMetric),
+        static_cast<uint8_t>(profile.weightColourByAlpha),
+        static_cast<uint8_t>(profile.alphaPreprocess)
+    };
+    key.settings = hashData(settings, sizeof(settings));
+    return key;
+}
+
+// The input itself, or a preprocessed copy of it held in storage
+const uint8_t* preprocessPixels(const uint8_t* rgba, uint32_t width, uint32_t height,
+                                AlphaPreprocess preprocess, std::vector<uint8_t>& storage) {
+    if (preprocess == AlphaPreprocess::None) {
+        return rgba;
+    }
+    storage.assign(rgba, rgba + static_cast<size_t>(width) * height * 4);
+    TextureConverter::applyAlphaPreprocess(storage.data(), width, height, preprocess);
+    return storage.data();
+}
+
+CacheKey makePaletteCacheKey(const uint8_t* rgba, uint32_t width, uint32_t height,
+                             uint32_t paletteSize, const PaletteOptions& options) {
+    CacheKey key;
+    key.pixelHash = hashData(rgba, static_cast<size_t>(width) * height * 4);
+    key.width = width;
+    key.height = height;
+    key.format = 0x100 | paletteSize;
+    // threadCount does not change the result
+    int32_t settings[4] = { options.speed, options.minQuality, options.maxQuality, 0 };
+    std::memcpy(&settings[3], &options.ditheringLevel, sizeof(float));
+    key.settings = hashData(settings, sizeof(settings));
+    return key;
+}
+
+// Alpha and grayscale flags of an RGBA8 image, vectorised four pixels at a time
+void scanAlphaAndGray(const uint8_t* rgba, size_t pixelCount, bool& allOpaque, bool& allBinary, bool& gray) {
+    allOpaque = true;
+    allBinary = true;
+    gray = true;
+    size_t i = 0;
+    
+#ifdef LIBTXD_USE_SSE2
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i channelMask = _mm_set1_epi32(0x0000FFFF);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i opaqueLanes = _mm_set1_epi32(-1);
+    __m128i binaryLanes = opaqueLanes;
+    __m128i grayDiff = zero;
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4));
+        __m128i alpha = _mm_and_si128(v, alphaMask);
+        __m128i opaque = _mm_cmpeq_epi32(alpha, alphaMask);
+        opaqueLanes = _mm_and_si128(opaqueLanes, opaque);
+        binaryLanes = _mm_and_si128(binaryLanes, _mm_or_si128(opaque, _mm_cmpeq_epi32(alpha, zero)));
+        // Bytes 0 and 1 hold R^G and G^B
+        grayDiff = _mm_or_si128(grayDiff, _mm_and_si128(_mm_xor_si128(v, _mm_srli_epi32(v, 8)), channelMask));
+    }
+    allOpaque = _mm_movemask_epi8(opaqueLanes) == 0xFFFF;
+    allBinary = _mm_movemask_epi8(binaryLanes) == 0xFFFF;
+    gray = _mm_movemask_epi8(_mm_cmpeq_epi8(grayDiff, zero)) == 0xFFFF;
+#endif
+    
+    for (; i < pixelCount; i++) {
+        const uint8_t* p = rgba + i * 4;
+        allOpaque = allOpaque && p[3] == 255;
+        allBinary = allBinary && (p[3] == 0 || p[3] == 255);
+        gray = gray && p[0] == p[1] && p[1] == p[2];
+    }
+}
+
+// Distinct RGBA values, counting stops once limit is exceeded
+uint32_t countColours(const uint8_t* rgba, size_t pixelCount, uint32_t limit) {
+    // Open addressing table at most a quarter full
+    const size_t tableSize = 1024;
+    uint32_t keys[tableSize];
+    bool used[tableSize] = {};
+    uint32_t count = 0;
+    uint32_t previous = 0;
+    
+    for (size_t i = 0; i < pixelCount; i++) {
+        uint32_t colour;
+        std::memcpy(&colour, rgba + i * 4, 4);
+        if (i > 0 && colour == previous) {
+            continue;
+        }
+        previous = colour;
+        
+        size_t slot = (colour * 0x9E3779B1u) >> 22;
+        while (used[slot] && keys[slot] != colour) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (!used[slot]) {
+            used[slot] = true;
+            keys[slot] = colour;
+            if (++count > limit) {
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// RGB PSNR with each pixel weighted by the reference alpha, so colour under
+// fully transparent pixels does not count
+double alphaWeightedPsnr(const uint8_t* reference, const uint8_t* test, size_t pixelCount) {
+    uint64_t weightedError = 0;
+    uint64_t totalWeight = 0;
+    for (size_t i = 0; i < pixelCount; i++) {
+        const uint8_t* r = reference + i * 4;
+        const uint8_t* t = test + i * 4;
+        uint32_t error = 0;
+        for (int c = 0; c < 3; c++) {
+            int diff = static_cast<int>(r[c]) - t[c];
+            error += static_cast<uint32_t>(diff * diff);
+        }
+        weightedError += static_cast<uint64_t>(error) * r[3];
+        totalWeight += r[3];
+    }
+    if (totalWeight == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return psnrFromMse(static_cast<double>(weightedError) / (totalWeight * 3.0));
+}
+
+QualityMetrics losslessMetrics() {
+    QualityMetrics metrics = {};
+    for (int c = 0; c < 4; c++) {
+        metrics.psnr[c] = std::numeric_limits<double>::infinity();
+    }
+    metrics.rgbPsnr = std::numeric_limits<double>::infinity();
+    metrics.ssim = 1.0;
+    metrics.alphaSsim = 1.0;
+    return metrics;
+}
+
+} // namespace
+
+std::unique_ptr<uint8_t[]> TextureConverter::decompressDXT(
+    const uint8_t* compressedData,
+    uint32_t width,
+    uint32_t height,
+    Compression compression) {
+    
+    if (!compressedData || width == 0 || height == 0) {
+        return nullptr;
+    }
+    
+    auto output = std::make_unique<uint8_t[]>(width * height * 4);
+    
+    int flags = 0;
+    switch (compression) {
+        case Compression::DXT1:
+            flags = squish::kDxt1;
+            break;
+        case Compression::DXT3:
+            flags = squish::kDxt3;
+            break;
+        case Compression::DXT5:
+            flags = squish::kDxt5;
+            break;
+        default:
+            return nullptr;
+    }
+    
+    // Decompress using squish
+    squish::DecompressImage(output.get(), static_cast<int>(width), static_cast<int>(height), compressedData, flags);
+    
+    return output;
+}
+
+QualityMetrics TextureConverter::measureQuality(
+    const uint8_t* reference,
+    const uint8_t* test,
+    uint32_t width,
+    uint32_t height) {
+    
+    QualityMetrics metrics = {};
+    if (!reference || !test || width == 0 || height == 0) {
+        return metrics;
+    }
+    
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    uint64_t sumSquared[4];
+    accumulateErrors(reference, test, pixelCount, sumSquared, metrics.maxError);
+    
+    for (int c = 0; c < 4; c++) {
+        metrics.mse[c] = static_cast<double>(sumSquared[c]) / pixelCount;
+        metrics.psnr[c] = psnrFromMse(metrics.mse[c]);
+    }
+    metrics.rgbMse = (metrics.mse[0] + metrics.mse[1] + metrics.mse[2]) / 3.0;
+    metrics.rgbPsnr = psnrFromMse(metrics.rgbMse);
+    
+    // Premultiplying luma by alpha hides colour differences under transparency
+    std::vector<float> planes(pixelCount * 4);
+    float* lumaRef = planes.data();
+    float* lumaTest = lumaRef + pixelCount;
+    float* alphaRef = lumaTest + pixelCount;
+    float* alphaTest = alphaRef + pixelCount;
+    for (size_t i = 0; i < pixelCount; i++) {
+        const uint8_t* r = reference + i * 4;
+        const uint8_t* t = test + i * 4;
+        lumaRef[i] = (0.299f * r[0] + 0.587f * r[1] + 0.114f * r[2]) * (r[3] / 255.0f);
+        lumaTest[i] = (0.299f * t[0] + 0.587f * t[1] + 0.114f * t[2]) * (t[3] / 255.0f);
+        alphaRef[i] = r[3];
+        alphaTest[i] = t[3];
+    }
+    metrics.ssim = meanSSIM(lumaRef, lumaTest, width, height);
+    metrics.alphaSsim = meanSSIM(alphaRef, alphaTest, width, height);
+    
+    return metrics;
+}
+
+std::unique_ptr<uint8_t[]> TextureConverter::compressAndMeasure(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    Compression compression,
+    QualityMetrics& metrics,
+    const CompressionProfile& profile) {
+    
+    auto compressed = compressToDXT(rgbaData, width, height, compression, profile);
+    if (!compressed) {
+        return nullptr;
+    }
+    auto decoded = decompressDXT(compressed.get(), width, height, compression);
+    if (!decoded) {
+        return nullptr;
+    }
+    metrics = measureQuality(rgbaData, decoded.get(), width, height);
+    return compressed;
+}
+
+std::unique_ptr<uint8_t[]> TextureConverter::transcodeDXT(
+    const uint8_t* compressedData,
+    uint32_t width,
+    uint32_t height,
+    Compression from,
+    Compression to) {
+    
+    size_t sourceSize = getCompressedDataSize(width, height, from);
+    size_t targetSize = getCompressedDataSize(width, height, to);
+    if (!compressedData || width == 0 || height == 0 || sourceSize == 0 || targetSize == 0) {
+        return nullptr;
+    }
+    
+    auto output = std::make_unique<uint8_t[]>(targetSize);
+    if (from == to) {
+        std::memcpy(output.get(), compressedData, sourceSize);
+        return output;
+    }
+    
+    const size_t sourceBlockSize = from == Compression::DXT1 ? 8 : 16;
+    const size_t targetBlockSize = to == Compression::DXT1 ? 8 : 16;
+    const size_t blockCount = sourceSize / sourceBlockSize;
+    const int targetFlags = to == Compression::DXT3 ? squish::kDxt3 : squish::kDxt5;
+    
+    for (size_t i = 0; i < blockCount; i++) {
+        const uint8_t* src = compressedData + i * sourceBlockSize;
+        uint8_t* dst = output.get() + i * targetBlockSize;
+        
+        if (to == Compression::DXT1) {
+            bool opaque = from == Compression::DXT3 ? alphaBlockOpaque(src) : alphaBlockOpaqueDXT5(src);
+            if (!opaque) {
+                return nullptr;
+            }
+            transcodeColourToDXT1(src + 8, dst);
+        } else if (from == Compression::DXT1) {
+            uint8_t block[16];
+            if (!transcodeBlockToDXT3(src, block)) {
+                uint8_t pixels[64];
+                squish::Decompress(pixels, src, squish::kDxt1);
+                // Transparent pixels decode as black and must not pull the colour fit
+                squish::Compress(pixels, dst, targetFlags | squish::kColourIterativeClusterFit |
+                                              squish::kWeightColourByAlpha);
+                continue;
+            }
+            if (to == Compression::DXT3) {
+                std::memcpy(dst, block, 16);
+            } else {
+                binaryAlphaToDXT5(block, dst);
+                std::memcpy(dst + 8, block + 8, 8);
+            }
+        } else {
+            // DXT3 and DXT5 share the colour block; only alpha is re-encoded
+            uint8_t pixels[64];
+            squish::Decompress(pixels, src, from == Compression::DXT3 ? squish::kDxt3 : squish::kDxt5);
+            if (to == Compression::DXT3) {
+                compressAlphaBlockDXT3(pixels, dst);
+            } else {
+                uint8_t block[16];
+                squish::Compress(pixels, block, squish::kDxt5 | squish::kColourRangeFit);
+                std::memcpy(dst, block, 8);
+            }
+            std::memcpy(dst + 8, src + 8, 8);
+        }
+    }
+    return output;
+}
+
+bool TextureConverter::transcodeTexture(Texture& texture, Compression to) {
+    const Compression from = texture.getCompression();
+    if (from == Compression::NONE || getCompressedDataSize(4, 4, to) == 0) {
+        return false;
+    }
+    if (from == to) {
+        return true;
+    }
+    
+    // Transcode every level before touching the texture so failure leaves it intact
+    std::vector<std::vector<uint8_t>> levels;
+    levels.reserve(texture.getMipmapCount());
+    for (uint32_t i = 0; i < texture.getMipmapCount(); i++) {
+        const MipmapLevel& mip = texture.getMipmap(i);
+        if (mip.data.size() < getCompressedDataSize(mip.width, mip.height, from)) {
+            return false;
+        }
+        auto transcoded = transcodeDXT(mip.data.data(), mip.width, mip.height, from, to);
+        if (!transcoded) {
+            return false;
+        }
+        size_t size = getCompressedDataSize(mip.width, mip.height, to);
+        levels.emplace_back(transcoded.get(), transcoded.get() + size);
+    }
+    
+    for (uint32_t i = 0; i < texture.getMipmapCount(); i++) {
+        MipmapLevel& mip = texture.getMipmap(i);
+        mip.data = std::move(levels[i]);
+        mip.dataSize = static_cast<uint32_t>(mip.data.size());
+    }
+    
+    const uint32_t flags = static_cast<uint32_t>(texture.getRasterFormat()) & ~static_cast<uint32_t>(RasterFormat::MASK);
+    if (to == Compression::DXT1) {
+        // Opaque DXT3/DXT5 data has no alpha left to describe
+        texture.setHasAlpha(false);
+    }
+    RasterFormat base = getDXTRasterFormat(to, texture.hasAlpha());
+    texture.setRasterFormat(static_cast<RasterFormat>(flags | static_cast<uint32_t>(base)));
+    texture.setCompression(to);
+    return true;
+}
+
+void TextureConverter::setCompressionCache(std::shared_ptr<CompressionCache> cache) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    activeCache = std::move(cache);
+}
+
+std::shared_ptr<CompressionCache> TextureConverter::getCompressionCache() {
+    return currentCache();
+}
+
+std::unique_ptr<uint8_t[]> TextureConverter::compressToDXT(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    Compression compression,
+    const CompressionProfile& profile) {
+    
+    size_t compressedSize = getCompressedDataSize(width, height, compression);
+    if (!rgbaData || width == 0 || height == 0 || compressedSize == 0) {
+        return nullptr;
+    }
+    
+    auto cache = currentCache();
+    CacheKey key;
+    if (cache) {
+        key = makeDXTCacheKey(rgbaData, width, height, compression, profile);
+        std::vector<uint8_t> cached;
+        if (cache->load(key, cached) && cached.size() == compressedSize) {
+            auto compressedData = std::make_unique<uint8_t[]>(compressedSize);
+            std::memcpy(compressedData.get(), cached.data(), compressedSize);
+            return compressedData;
+        }
+    }
+    
+    std::vector<uint8_t> prepared;
+    const uint8_t* source = preprocessPixels(rgbaData, width, height, profile.alphaPreprocess, prepared);
+    auto compressedData = compressUncached(source, width, height, compression, profile);
+    if (cache && compressedData) {
+        cache->store(key, compressedData.get(), compressedSize);
+    }
+    return compressedData;
+}
+
+std::unique_ptr<uint8_t[]> TextureConverter::compressUncached(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    Compression compression,
+    const CompressionProfile& profile) {
+    
+    if (!rgbaData || width == 0 || height == 0) {
+        return nullptr;
+    }
+    
+    int flags = 0;
+    switch (compression) {
+        case Compression::DXT1:
+            flags = squish::kDxt1;
+            break;
+        case Compression::DXT3:
+            flags = squish::kDxt3;
+            break;
+        case Compression::DXT5:
+            flags = squish::kDxt5;
+            break;
+        default:
+            return nullptr;
+    }
+    
+    size_t compressedSize = getCompressedDataSize(width, height, compression);
+    if (compressedSize == 0) {
+        return nullptr;
+    }
+    
+    auto compressedData = std::make_unique<uint8_t[]>(compressedSize);
+    
+    switch (profile.speed) {
+        case CompressionSpeed::Realtime:
+            compressRealtime(rgbaData, width, height, compression, compressedData.get());
+            return compressedData;
+        case CompressionSpeed::RangeFit:
+            flags |= squish::kColourRangeFit;
+            break;
+        case CompressionSpeed::ClusterFit:
+            flags |= squish::kColourClusterFit;
+            break;
+        case CompressionSpeed::IterativeClusterFit:
+            flags |= squish::kColourIterativeClusterFit;
+            break;
+    }
+    
+    flags |= profile.perceptualMetric ? squish::kColourMetricPerceptual : squish::kColourMetricUniform;
+    if (profile.weightColourByAlpha) {
+        flags |= squish::kWeightColourByAlpha;
+    }
+    
+    // Same traversal as squish::CompressImage, but each fit is a pure function
+    // of the block, so repeated full blocks are copied from the memo table
+    const size_t bytesPerBlock = compression == Compression::DXT1 ? 8 : 16;
+    BlockMemo memo(compressedSize / bytesPerBlock);
+    uint8_t* out = compressedData.get();
+    
+    for (uint32_t by = 0; by < height; by += 4) {
+        for (uint32_t bx = 0; bx < width; bx += 4) {
+            uint8_t block[64] = {};
+            int mask = 0;
+            for (uint32_t py = 0; py < 4 && by + py < height; py++) {
+                uint32_t count = std::min(4u, width - bx);
+                std::memcpy(block + py * 16, rgbaData + (static_cast<size_t>(by + py) * width + bx) * 4, count * 4);
+                mask |= ((1 << count) - 1) << (py * 4);
+            }
+            
+            if (mask != 0xFFFF) {
+                squish::CompressMasked(block, mask, out, flags);
+            } else {
+                bool hit;
+                BlockMemo::Entry& entry = memo.find(block, hit);
+                if (hit) {
+                    std::memcpy(out, entry.encoded, bytesPerBlock);
+                } else {
+                    squish::CompressMasked(block, mask, out, flags);
+                    BlockMemo::fill(entry, block, out, bytesPerBlock);
+                }
+            }
+            out += bytesPerBlock;
+        }
+    }
+    
+    return compressedData;
+}
+
+std::vector<std::vector<uint8_t>> TextureConverter::compressBatch(
+    const std::vector<CompressionJob>& jobs,
+    int threadCount) {
+    
+    // Block rows per work item: large enough to amortise scheduling, small
+    // enough that one big texture does not leave the other threads idle
+    constexpr uint32_t kBandBlockRows = 16;
+    
+    struct WorkItem {
+        size_t job;
+        uint32_t firstBlockRow;
+        uint32_t blockRows;
+    };
+    
+    std::vector<std::vector<uint8_t>> results(jobs.size());
+    std::vector<size_t> valid;
+    
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const CompressionJob& job = jobs[i];
+        if (job.rgba && job.width != 0 && job.height != 0 &&
+            getCompressedDataSize(job.width, job.height, job.compression) != 0) {
+            valid.push_back(i);
+        }
+    }
+    
+    auto cache = currentCache();
+    std::vector<CacheKey> keys(cache ? jobs.size() : 0);
+    std::vector<uint8_t> cached(jobs.size(), 0);
+    std::vector<const uint8_t*> sources(jobs.size(), nullptr);
+    std::vector<std::vector<uint8_t>> prepared(jobs.size());
+    
+    ScopedOpenMPThreads threads(threadCount);
+    const int64_t validCount = static_cast<int64_t>(valid.size());
+    
+    // Hashing, cache reads and preprocessing are per image work, so they run
+    // in parallel ahead of the band split. Preprocessing sees the whole image.
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int64_t n = 0; n < validCount; n++) {
+        const size_t i = valid[static_cast<size_t>(n)];
+        const CompressionJob& job = jobs[i];
+        size_t size = getCompressedDataSize(job.width, job.height, job.compression);
+        if (cache) {
+            keys[i] = makeDXTCacheKey(job.rgba, job.width, job.height, job.compression, job.profile);
+            if (cache->load(keys[i], results[i]) && results[i].size() == size) {
+                cached[i] = 1;
+                continue;
+            }
+        }
+        results[i].resize(size);
+        sources[i] = preprocessPixels(job.rgba, job.width, job.height, job.profile.alphaPreprocess, prepared[i]);
+    }
+    
+    std::vector<WorkItem> items;
+    for (size_t i : valid) {
+        if (cached[i]) {
+            continue;
+        }
+        uint32_t blockRows = (jobs[i].height + 3) / 4;
+        for (uint32_t row = 0; row < blockRows; row += kBandBlockRows) {
+            items.push_back({ i, row, std::min(kBandBlockRows, blockRows - row) });
+        }
+    }
+    
+    // Set by any band that fails, so the whole job is reported as failed
+    std::unique_ptr<std::atomic<bool>[]> failed(new std::atomic<bool>[jobs.size()]);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        failed[i] = false;
+    }
+    const int64_t itemCount = static_cast<int64_t>(items.size());
+    
+    // Blocks are encoded independently, so a band of whole block rows
+    // compresses to exactly the matching slice of the full image
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int64_t n = 0; n < itemCount; n++) {
+        const WorkItem& item = items[static_cast<size_t>(n)];
+        const CompressionJob& job = jobs[item.job];
+        
+        uint32_t firstRow = item.firstBlockRow * 4;
+        uint32_t bandHeight = std::min(item.blockRows * 4, job.height - firstRow);
+        const uint8_t* bandPixels = sources[item.job] + static_cast<size_t>(firstRow) * job.width * 4;
+        
+        auto band = compressUncached(bandPixels, job.width, bandHeight, job.compression, job.profile);
+        if (!band) {
+            failed[item.job] = true;
+            continue;
+        }
+        size_t bandSize = getCompressedDataSize(job.width, bandHeight, job.compression);
+        size_t offset = getCompressedDataSize(job.width, firstRow, job.compression);
+        std::memcpy(results[item.job].data() + offset, band.get(), bandSize);
+    }
+    
+    for (size_t i : valid) {
+        if (failed[i]) {
+            // An empty result tells the caller to fall back, never a partly zero image
+            results[i].clear();
+            results[i].shrink_to_fit();
+        } else if (cache && !cached[i]) {
+            cache->store(keys[i], results[i].data(), results[i].size());
+        }
+    }
+    
+    return results;
+}
+
+void TextureConverter::compressRealtime(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    Compression compression,
+    uint8_t* output) {
+    
+    const bool isDXT1 = compression == Compression::DXT1;
+    uint8_t block[64];
+    uint8_t* out = output;
+    
+    for (uint32_t by = 0; by < height; by += 4) {
+        for (uint32_t bx = 0; bx < width; bx += 4) {
+            loadBlock(rgbaData, width, height, bx, by, block);
+            
+            if (isDXT1) {
+                if (blockHasTransparency(block)) {
+                    // Punch-through alpha needs the 3-colour mode, leave those blocks to squish
+                    int mask = 0;
+                    for (uint32_t py = 0; py < 4; py++) {
+                        for (uint32_t px = 0; px < 4; px++) {
+                            if (bx + px < width && by + py < height) {
+                                mask |= 1 << (py * 4 + px);
+                            }
+                        }
+                    }
+                    squish::CompressMasked(block, mask, out, squish::kDxt1 | squish::kColourRangeFit);
+                } else {
+                    compressColourBlockRealtime(block, out);
+                }
+                out += 8;
+            } else {
+                if (compression == Compression::DXT5) {
+                    compressAlphaBlockDXT5(block, out);
+                } else {
+                    compressAlphaBlockDXT3(block, out);
+                }
+                compressColourBlockRealtime(block, out + 8);
+                out += 16;
+            }
+        }
+    }
+}
+
+std::vector<ProfileBenchmark> TextureConverter::benchmarkProfiles(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    Compression compression,
+    bool weightColourByAlpha) {
+    
+    std::vector<ProfileBenchmark> results;
+    if (!rgbaData || width == 0 || height == 0 || getCompressedDataSize(width, height, compression) == 0) {
+        return results;
+    }
+    
+    const std::pair<const char*, CompressionProfile> namedProfiles[] = {
+        { "realtime", CompressionProfile::realtime() },
+        { "range fit", CompressionProfile::rangeFit() },
+        { "cluster fit", CompressionProfile::clusterFit() },
+        { "iterative cluster fit", CompressionProfile::iterativeClusterFit() },
+        { "uniform", CompressionProfile::uniform() },
+    };
+    
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    const int channels = compression == Compression::DXT1 ? 3 : 4;
+    
+    for (const auto& named : namedProfiles) {
+        CompressionProfile profile = named.second;
+        profile.weightColourByAlpha = weightColourByAlpha;
+        
+        auto start = std::chrono::steady_clock::now();
+        auto compressed = compressUncached(rgbaData, width, height, compression, profile);
+        auto end = std::chrono::steady_clock::now();
+        if (!compressed) {
+            return {};
+        }
+        
+        auto decompressed = decompressDXT(compressed.get(), width, height, compression);
+        if (!decompressed) {
+            return {};
+        }
+        
+        uint64_t channelSums[4];
+        uint8_t maxError[4];
+        accumulateErrors(rgbaData, decompressed.get(), pixelCount, channelSums, maxError);
+        double sumSquared = 0.0;
+        for (int c = 0; c < channels; c++) {
+            sumSquared += static_cast<double>(channelSums[c]);
+        }
+        double mse = sumSquared / (static_cast<double>(pixelCount) * channels);
+        double seconds = std::chrono::duration<double>(end - start).count();
+        
+        ProfileBenchmark result;
+        result.name = named.first;
+        result.profile = profile;
+        result.megapixelsPerSecond = seconds > 0.0 ? (pixelCount / 1.0e6) / seconds
+                                                   : std::numeric_limits<double>::infinity();
+        result.rmse = std::sqrt(mse);
+        result.psnr = psnrFromMse(mse);
+        results.push_back(std::move(result));
+    }
+    
+    return results;
+}
+
+uint32_t TextureConverter::getUncompressedPixelSize(RasterFormat format) {
+    switch (static_cast<uint32_t>(format) & static_cast<uint32_t>(RasterFormat::MASK)) {
+        case static_cast<uint32_t>(RasterFormat::B8G8R8A8):
+            return 4;
+        case static_cast<uint32_t>(RasterFormat::B8G8R8):
+            return 3;
+        case static_cast<uint32_t>(RasterFormat::R5G6B5):
+        case static_cast<uint32_t>(RasterFormat::A1R5G5B5):
+        case static_cast<uint32_t>(RasterFormat::R4G4B4A4):
+            return 2;
+        case static_cast<uint32_t>(RasterFormat::LUM8):
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+bool TextureConverter::encodeUncompressed(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    RasterFormat format,
+    uint8_t* output,
+    DitherMode dither) {
+    
+    uint32_t pixelSize = getUncompressedPixelSize(format);
+    if (!rgbaData || !output || width == 0 || height == 0 || pixelSize == 0) {
+        return false;
+    }
+    
+    const uint32_t baseFormat = static_cast<uint32_t>(format) & static_cast<uint32_t>(RasterFormat::MASK);
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    
+    PackedFormat packed;
+    if (getPackedFormat(baseFormat, packed)) {
+        if (dither == DitherMode::ErrorDiffusion) {
+            encodePackedDiffused(rgbaData, width, height, packed, output);
+        } else {
+            for (uint32_t y = 0; y < height; y++) {
+                encodePackedRow(rgbaData + static_cast<size_t>(y) * width * 4, width, y, packed,
+                                dither == DitherMode::Ordered, output + static_cast<size_t>(y) * width * 2);
+            }
+        }
+        return true;
+    }
+    
+    switch (baseFormat) {
+        case static_cast<uint32_t>(RasterFormat::B8G8R8A8):
+            for (size_t i = 0; i < pixelCount; i++) {
+                output[i * 4 + 0] = rgbaData[i * 4 + 2];
+                output[i * 4 + 1] = rgbaData[i * 4 + 1];
+                output[i * 4 + 2] = rgbaData[i * 4 + 0];
+                output[i * 4 + 3] = rgbaData[i * 4 + 3];
+            }
+            break;
+        case static_cast<uint32_t>(RasterFormat::B8G8R8):
+            for (size_t i = 0; i < pixelCount; i++) {
+                output[i * 3 + 0] = rgbaData[i * 4 + 2];
+                output[i * 3 + 1] = rgbaData[i * 4 + 1];
+                output[i * 3 + 2] = rgbaData[i * 4 + 0];
+            }
+            break;
+        case static_cast<uint32_t>(RasterFormat::LUM8):
+            encodeLuminanceRow(rgbaData, static_cast<uint32_t>(pixelCount), output);
+            break;
+    }
+    return true;
+}
+
+void TextureConverter::extractAlpha(const uint8_t* rgbaData, size_t pixelCount, uint8_t* alpha) {
+    size_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+    // Sixteen pixels per iteration: shift alpha down, then narrow 32 -> 8 bits
+    const __m128i* in = reinterpret_cast<const __m128i*>(rgbaData);
+    for (; i + 16 <= pixelCount; i += 16, in += 4) {
+        __m128i a0 = _mm_srli_epi32(_mm_loadu_si128(in), 24);
+        __m128i a1 = _mm_srli_epi32(_mm_loadu_si128(in + 1), 24);
+        __m128i a2 = _mm_srli_epi32(_mm_loadu_si128(in + 2), 24);
+        __m128i a3 = _mm_srli_epi32(_mm_loadu_si128(in + 3), 24);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(alpha + i), packed);
+    }
+#endif
+    for (; i < pixelCount; i++) {
+        alpha[i] = rgbaData[i * 4 + 3];
+    }
+}
+
+void TextureConverter::insertAlpha(uint8_t* rgbaData, size_t pixelCount, const uint8_t* alpha) {
+    size_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+    // Widen sixteen alpha bytes to the top byte of each 32-bit pixel
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i* out = reinterpret_cast<__m128i*>(rgbaData);
+    for (; i + 16 <= pixelCount; i += 16, out += 4) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alpha + i));
+        __m128i lo = _mm_unpacklo_epi8(zero, a);
+        __m128i hi = _mm_unpackhi_epi8(zero, a);
+        __m128i shifted[4] = {
+            _mm_unpacklo_epi16(zero, lo), _mm_unpackhi_epi16(zero, lo),
+            _mm_unpacklo_epi16(zero, hi), _mm_unpackhi_epi16(zero, hi)
+        };
+        for (int k = 0; k < 4; k++) {
+            __m128i rgb = _mm_and_si128(_mm_loadu_si128(out + k), rgbMask);
+            _mm_storeu_si128(out + k, _mm_or_si128(rgb, shifted[k]));
+        }
+    }
+#endif
+    for (; i < pixelCount; i++) {
+        rgbaData[i * 4 + 3] = alpha[i];
+    }
+}
+
+void TextureConverter::stripAlpha(const uint8_t* rgbaData, size_t pixelCount, uint8_t* rgb) {
+    if (pixelCount == 0) {
+        return;
+    }
+    // Whole 4-byte copies overlap: each pixel's stray alpha byte is overwritten
+    // by the next pixel, so only the last pixel needs a 3-byte copy
+    for (size_t i = 0; i + 1 < pixelCount; i++) {
+        std::memcpy(rgb + i * 3, rgbaData + i * 4, 4);
+    }
+    std::memcpy(rgb + (pixelCount - 1) * 3, rgbaData + (pixelCount - 1) * 4, 3);
+}
+
+void TextureConverter::extractLuminance(const uint8_t* rgbaData, size_t pixelCount, uint8_t* luminance) {
+    size_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+    // Four pixels per iteration: (77 R + 150 G + 29 B + 128) >> 8 with madd
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_setr_epi16(77, 150, 29, 0, 77, 150, 29, 0);
+    const __m128i rounding = _mm_set1_epi32(128);
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgbaData + i * 4));
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights);
+        // Each pixel's sum is split over two adjacent 32-bit lanes
+        __m128i sums = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi),
+                                                                     _MM_SHUFFLE(2, 0, 2, 0))),
+                                     _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi),
+                                                                     _MM_SHUFFLE(3, 1, 3, 1))));
+        sums = _mm_srli_epi32(_mm_add_epi32(sums, rounding), 8);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sums, sums), zero);
+        uint32_t four = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+        std::memcpy(luminance + i, &four, 4);
+    }
+#endif
+    for (; i < pixelCount; i++) {
+        const uint8_t* p = rgbaData + i * 4;
+        luminance[i] = static_cast<uint8_t>((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+}
+
+AlphaClass TextureConverter::classifyAlpha(const uint8_t* rgbaData, size_t pixelCount) {
+    bool opaque = true;
+    size_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+    // Per lane: alpha is 255, alpha is 0 or 255; checked every sixteen pixels
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= pixelCount; i += 16) {
+        __m128i allOpaque = _mm_set1_epi32(-1);
+        __m128i allBinary = _mm_set1_epi32(-1);
+        for (int k = 0; k < 4; k++) {
+            __m128i a = _mm_and_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgbaData + (i + k * 4) * 4)), alphaMask);
+            __m128i isOpaque = _mm_cmpeq_epi32(a, alphaMask);
+            allOpaque = _mm_and_si128(allOpaque, isOpaque);
+            allBinary = _mm_and_si128(allBinary, _mm_or_si128(isOpaque, _mm_cmpeq_epi32(a, zero)));
+        }
+        if (_mm_movemask_epi8(allBinary) != 0xFFFF) {
+            return AlphaClass::Smooth;
+        }
+        opaque = opaque && _mm_movemask_epi8(allOpaque) == 0xFFFF;
+    }
+#endif
+    for (; i < pixelCount; i++) {
+        uint8_t a = rgbaData[i * 4 + 3];
+        if (a != 255) {
+            if (a != 0) {
+                return AlphaClass::Smooth;
+            }
+            opaque = false;
+        }
+    }
+    return opaque ? AlphaClass::Opaque : AlphaClass::OneBit;
+}
+
+void TextureConverter::premultiplyAlpha(uint8_t* rgbaData, size_t pixelCount) {
+    size_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+    // Four pixels per iteration in 16-bit lanes. The alpha lane is multiplied
+    // by 255 so the shared divide-by-255 returns it unchanged.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaLane = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i rounding = _mm_set1_epi16(128);
+    auto premultiplyPair = [&](__m128i pixels) {
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xFF), 0xFF);
+        __m128i factor = _mm_or_si128(_mm_and_si128(alpha, rgbLanes), alphaLane);
+        __m128i x = _mm_add_epi16(_mm_mullo_epi16(pixels, factor), rounding);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(rgbaData + i * 4);
+        __m128i v = _mm_loadu_si128(p);
+        __m128i lo = premultiplyPair(_mm_unpacklo_epi8(v, zero));
+        __m128i hi = premultiplyPair(_mm_unpackhi_epi8(v, zero));
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < pixelCount; i++) {
+        uint8_t* p = rgbaData + i * 4;
+        for (int c = 0; c < 3; c++) {
+            uint32_t x = p[c] * p[3] + 128;
+            p[c] = static_cast<uint8_t>((x + (x >> 8)) >> 8);
+        }
+    }
+}
+
+void TextureConverter::unpremultiplyAlpha(uint8_t* rgbaData, size_t pixelCount) {
+    // 255 / alpha, with 1 for alpha 0 so transparent pixels keep their RGB
+    static const std::array<float, 256> scale = [] {
+        std::array<float, 256> table{};
+        table[0] = 1.0f;
+        for (int a = 1; a < 256; a++) {
+            table[a] = 255.0f / static_cast<float>(a);
+        }
+        return table;
+    }();
+    
+    size_t i = 0;
+#ifdef LIBTXD_USE_SSE2
+    // One pixel per float vector; packing with saturation clamps to 255
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 half = _mm_set1_ps(0.5f);
+    auto unpremultiplyPixel = [&](__m128i pixel16, const uint8_t* source) {
+        float s = scale[source[3]];
+        __m128 v = _mm_cvtepi32_ps(_mm_unpacklo_epi16(pixel16, zero));
+        v = _mm_add_ps(_mm_mul_ps(v, _mm_set_ps(1.0f, s, s, s)), half);
+        return _mm_cvttps_epi32(v);
+    };
+    for (; i + 4 <= pixelCount; i += 4) {
+        uint8_t* p = rgbaData + i * 4;
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i p0 = unpremultiplyPixel(lo, p);
+        __m128i p1 = unpremultiplyPixel(_mm_srli_si128(lo, 8), p + 4);
+        __m128i p2 = unpremultiplyPixel(hi, p + 8);
+        __m128i p3 = unpremultiplyPixel(_mm_srli_si128(hi, 8), p + 12);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packed);
+    }
+#endif
+    for (; i < pixelCount; i++) {
+        uint8_t* p = rgbaData + i * 4;
+        float s = scale[p[3]];
+        for (int c = 0; c < 3; c++) {
+            float v = static_cast<float>(p[c]) * s;
+            p[c] = static_cast<uint8_t>(std::min(255, static_cast<int>(v + 0.5f)));
+        }
+    }
+}
+
+void TextureConverter::bleedAlpha(uint8_t* rgbaData, uint32_t width, uint32_t height) {
+    if (!rgbaData || width == 0 || height == 0) {
+        return;
+    }
+    
+    // Pixel states: visible or already filled, waiting in the current ring, untouched
+    enum : uint8_t { Untouched, Queued, Filled };
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> state(pixelCount);
+    bool anyVisible = false;
+    for (size_t i = 0; i < pixelCount; i++) {
+        state[i] = rgbaData[i * 4 + 3] != 0 ? Filled : Untouched;
+        anyVisible = anyVisible || state[i] == Filled;
+    }
+    if (!anyVisible) {
+        return;
+    }
+    
+    auto forEachNeighbour = [&](size_t index, auto&& visit) {
+        const uint32_t x = static_cast<uint32_t>(index % width);
+        const uint32_t y = static_cast<uint32_t>(index / width);
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int64_t nx = static_cast<int64_t>(x) + dx;
+                int64_t ny = static_cast<int64_t>(y) + dy;
+                if ((dx != 0 || dy != 0) && nx >= 0 && ny >= 0 && nx < width && ny < height) {
+                    visit(static_cast<size_t>(ny) * width + static_cast<size_t>(nx));
+                }
+            }
+        }
+    };
+    
+    std::vector<size_t> ring;
+    for (size_t i = 0; i < pixelCount; i++) {
+        if (state[i] == Untouched) {
+            bool touchesFilled = false;
+            forEachNeighbour(i, [&](size_t n) { touchesFilled = touchesFilled || state[n] == Filled; });
+            if (touchesFilled) {
+                state[i] = Queued;
+                ring.push_back(i);
+            }
+        }
+    }
+    
+    // Each ring takes the average colour of its already filled neighbours, so
+    // the result does not depend on the order pixels are visited in
+    std::vector<size_t> nextRing;
+    std::vector<std::array<uint8_t, 3>> colours;
+    while (!ring.empty()) {
+        colours.resize(ring.size());
+        for (size_t r = 0; r < ring.size(); r++) {
+            uint32_t sum[3] = {};
+            uint32_t count = 0;
+            forEachNeighbour(ring[r], [&](size_t n) {
+                if (state[n] == Filled) {
+                    for (int c = 0; c < 3; c++) {
+                        sum[c] += rgbaData[n * 4 + c];
+                    }
+                    count++;
+                }
+            });
+            for (int c = 0; c < 3; c++) {
+                colours[r][c] = static_cast<uint8_t>((sum[c] + count / 2) / count);
+            }
+        }
+        
+        nextRing.clear();
+        for (size_t r = 0; r < ring.size(); r++) {
+            std::memcpy(rgbaData + ring[r] * 4, colours[r].data(), 3);
+            state[ring[r]] = Filled;
+        }
+        for (size_t index : ring) {
+            forEachNeighbour(index, [&](size_t n) {
+                if (state[n] == Untouched) {
+                    state[n] = Queued;
+                    nextRing.push_back(n);
+                }
+            });
+        }
+        ring.swap(nextRing);
+    }
+}
+
+void TextureConverter::applyAlphaPreprocess(uint8_t* rgbaData, uint32_t width, uint32_t height,
+                                            AlphaPreprocess preprocess) {
+    switch (preprocess) {
+        case AlphaPreprocess::None:
+            break;
+        case AlphaPreprocess::Premultiply:
+            premultiplyAlpha(rgbaData, static_cast<size_t>(width) * height);
+            break;
+        case AlphaPreprocess::Bleed:
+            bleedAlpha(rgbaData, width, height);
+            break;
+    }
+}
+
+TextureAnalysis TextureConverter::analyzeTexture(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height) {
+    
+    TextureAnalysis analysis;
+    if (!rgbaData || width == 0 || height == 0) {
+        return analysis;
+    }
+    
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    bool allOpaque, allBinary;
+    scanAlphaAndGray(rgbaData, pixelCount, allOpaque, allBinary, analysis.grayscale);
+    analysis.alpha = allOpaque ? AlphaClass::Opaque : (allBinary ? AlphaClass::OneBit : AlphaClass::Smooth);
+    analysis.colourCount = countColours(rgbaData, pixelCount, 256);
+    return analysis;
+}
+
+namespace {
+
+// B8G8R8A8, or B8G8R8 when the image is opaque
+FormatChoice losslessFormat(const TextureAnalysis& analysis, size_t pixelCount) {
+    const bool opaque = analysis.alpha == AlphaClass::Opaque;
+    FormatChoice lossless;
+    lossless.name = opaque ? "B8G8R8" : "B8G8R8A8";
+    lossless.rasterFormat = opaque ? RasterFormat::B8G8R8 : RasterFormat::B8G8R8A8;
+    lossless.depth = opaque ? 24 : 32;
+    lossless.bytes = pixelCount * (opaque ? 3 : 4);
+    lossless.metrics = losslessMetrics();
+    lossless.psnr = lossless.metrics.rgbPsnr;
+    return lossless;
+}
+
+// Lossy formats suited to the image's content that are smaller than the
+// lossless format, smallest first
+std::vector<FormatChoice> lossyFormats(const TextureAnalysis& analysis, uint32_t width, uint32_t height,
+                                       bool allowDXT, bool allowLowDepth, bool allowPalette) {
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    const bool opaque = analysis.alpha == AlphaClass::Opaque;
+    
+    std::vector<FormatChoice> candidates;
+    auto addCandidate = [&](const char* name, Compression compression, RasterFormat format,
+                            uint32_t depth, uint32_t paletteSize, size_t bytes) {
+        FormatChoice choice;
+        choice.name = name;
+        choice.compression = compression;
+        choice.rasterFormat = format;
+        choice.depth = depth;
+        choice.paletteSize = paletteSize;
+        choice.bytes = bytes;
+        candidates.push_back(choice);
+    };
+    auto withBase = [&](RasterFormat flag) {
+        RasterFormat base = opaque ? RasterFormat::B8G8R8 : RasterFormat::B8G8R8A8;
+        return static_cast<RasterFormat>(static_cast<uint32_t>(flag) | static_cast<uint32_t>(base));
+    };
+    
+    // Listed in order of preference among equal sizes: GPU-native formats first
+    if (allowDXT) {
+        if (opaque) {
+            addCandidate("DXT1", Compression::DXT1, TextureConverter::getDXTRasterFormat(Compression::DXT1, false), 16, 0,
+                         TextureConverter::getCompressedDataSize(width, height, Compression::DXT1));
+        } else {
+            if (analysis.alpha == AlphaClass::OneBit) {
+                addCandidate("DXT1a", Compression::DXT1, TextureConverter::getDXTRasterFormat(Compression::DXT1, true), 16, 0,
+                             TextureConverter::getCompressedDataSize(width, height, Compression::DXT1));
+            }
+            // Interpolated alpha usually beats DXT3's explicit 4-bit alpha at the same size
+            addCandidate("DXT5", Compression::DXT5, TextureConverter::getDXTRasterFormat(Compression::DXT5, true), 16, 0,
+                         TextureConverter::getCompressedDataSize(width, height, Compression::DXT5));
+            addCandidate("DXT3", Compression::DXT3, TextureConverter::getDXTRasterFormat(Compression::DXT3, true), 16, 0,
+                         TextureConverter::getCompressedDataSize(width, height, Compression::DXT3));
+        }
+    }
+    if (allowLowDepth) {
+        if (opaque && analysis.grayscale) {
+            addCandidate("LUM8", Compression::NONE, RasterFormat::LUM8, 8, 0, pixelCount);
+        }
+        RasterFormat format = opaque ? RasterFormat::R5G6B5 :
+            (analysis.alpha == AlphaClass::OneBit ? RasterFormat::A1R5G5B5 : RasterFormat::R4G4B4A4);
+        addCandidate(opaque ? "R5G6B5" : (analysis.alpha == AlphaClass::OneBit ? "A1R5G5B5" : "R4G4B4A4"),
+                     Compression::NONE, format, 16, 0, pixelCount * 2);
+    }
+    if (allowPalette) {
+        // Index data is stored one byte per pixel for PAL4 as well
+        addCandidate("PAL4", Compression::NONE, withBase(RasterFormat::PAL4), 4, 16, pixelCount + 16 * 4);
+        addCandidate("PAL8", Compression::NONE, withBase(RasterFormat::PAL8), 8, 256, pixelCount + 256 * 4);
+    }
+    // Palettes of tiny images can outgrow the lossless format
+    const size_t losslessBytes = losslessFormat(analysis, pixelCount).bytes;
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](const FormatChoice& c) { return c.bytes >= losslessBytes; }),
+                     candidates.end());
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const FormatChoice& a, const FormatChoice& b) { return a.bytes < b.bytes; });
+    return candidates;
+}
+
+// Encodes an image in a lossy format and decodes it back to RGBA8
+// Returns nullptr if the format could not be produced.
+std::unique_ptr<uint8_t[]> encodeRoundTrip(const uint8_t* rgbaData, uint32_t width, uint32_t height,
+                                           const FormatChoice& format, const TextureAnalysis& analysis,
+                                           const CompressionProfile& profile, PaletteOptions paletteOptions,
+                                           DitherMode dither) {
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    
+    if (format.compression != Compression::NONE) {
+        auto compressed = TextureConverter::compressToDXT(rgbaData, width, height, format.compression, profile);
+        return compressed ? TextureConverter::decompressDXT(compressed.get(), width, height, format.compression)
+                          : nullptr;
+    }
+    
+    if (format.paletteSize > 0) {
+        // When every colour fits, dithering would only add noise
+        if (analysis.colourCount <= format.paletteSize) {
+            paletteOptions.ditheringLevel = 0.0f;
+        }
+        std::vector<uint8_t> palette, indices;
+        if (!TextureConverter::generatePalette(rgbaData, width, height, format.paletteSize, palette, indices,
+                                               paletteOptions)) {
+            return nullptr;
+        }
+        auto decoded = std::make_unique<uint8_t[]>(pixelCount * 4);
+        TextureConverter::convertPaletteToRGBA(indices.data(), palette.data(), format.paletteSize,
+                                               width, height, decoded.get());
+        return decoded;
+    }
+    
+    uint32_t pixelSize = TextureConverter::getUncompressedPixelSize(format.rasterFormat);
+    MipmapLevel level;
+    level.width = width;
+    level.height = height;
+    level.data.resize(pixelCount * pixelSize);
+    level.dataSize = static_cast<uint32_t>(level.data.size());
+    if (!TextureConverter::encodeUncompressed(rgbaData, width, height, format.rasterFormat, level.data.mutableData(),
+                                              dither)) {
+        return nullptr;
+    }
+    Texture texture;
+    texture.setRasterFormat(format.rasterFormat);
+    texture.setDepth(format.depth);
+    texture.addMipmap(std::move(level));
+    return TextureConverter::convertToRGBA8(texture);
+}
+
+} // namespace
+
+FormatChoice TextureConverter::selectFormat(
+    const uint8_t* rgbaData,
     uint32_t width,
     uint32_t height,
-    Compression compression) {
+    const FormatSelectionOptions& options) {
+    
+    if (!rgbaData || width == 0 || height == 0) {
+        return FormatChoice();
+    }
+    
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    const TextureAnalysis analysis = analyzeTexture(rgbaData, width, height);
+    const bool opaque = analysis.alpha == AlphaClass::Opaque;
+    
+    auto candidates = lossyFormats(analysis, width, height, options.allowDXT, options.allowLowDepth,
+                                   options.allowPalette);
+    for (auto& candidate : candidates) {
+        auto result = encodeRoundTrip(rgbaData, width, height, candidate, analysis, options.profile,
+                                      options.paletteOptions, options.dither);
+        if (!result) {
+            continue;
+        }
+        candidate.metrics = measureQuality(rgbaData, result.get(), width, height);
+        candidate.psnr = alphaWeightedPsnr(rgbaData, result.get(), pixelCount);
+        if (candidate.psnr >= options.minPsnr && candidate.metrics.ssim >= options.minSsim &&
+            (opaque || candidate.metrics.psnr[3] >= options.minAlphaPsnr)) {
+            return candidate;
+        }
+    }
+    
+    return losslessFormat(analysis, pixelCount);
+}
+
+namespace {
+
+bool formatHasAlpha(RasterFormat format) {
+    switch (static_cast<uint32_t>(format) & static_cast<uint32_t>(RasterFormat::MASK)) {
+        case static_cast<uint32_t>(RasterFormat::B8G8R8A8):
+        case static_cast<uint32_t>(RasterFormat::A1R5G5B5):
+        case static_cast<uint32_t>(RasterFormat::R4G4B4A4):
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Bytes a texture of this size and format stores: palette plus every level
+size_t storedBytes(const FormatChoice& format, uint32_t width, uint32_t height, bool mipmaps) {
+    const uint32_t levels = mipmaps ? Texture::getFullMipmapCount(width, height) : 1;
+    const uint32_t pixelSize = format.paletteSize > 0 ? 1 : TextureConverter::getUncompressedPixelSize(format.rasterFormat);
+    size_t bytes = static_cast<size_t>(format.paletteSize) * 4;
+    for (uint32_t level = 0; level < levels; level++) {
+        uint32_t levelWidth, levelHeight;
+        Texture::getMipmapDimensions(width, height, level, format.compression, levelWidth, levelHeight);
+        bytes += format.compression != Compression::NONE
+            ? TextureConverter::getCompressedDataSize(levelWidth, levelHeight, format.compression)
+            : static_cast<size_t>(levelWidth) * levelHeight * pixelSize;
+    }
+    return bytes;
+}
+
+// Squared error summed over all pixels; colour error is weighted by source
+// alpha so invisible texels cost nothing
+double budgetError(const uint8_t* reference, const uint8_t* test, size_t pixelCount) {
+    double total = 0.0;
+    for (size_t i = 0; i < pixelCount; i++) {
+        const uint8_t* r = reference + i * 4;
+        const uint8_t* t = test + i * 4;
+        int colour = 0;
+        for (int c = 0; c < 3; c++) {
+            int diff = static_cast<int>(r[c]) - t[c];
+            colour += diff * diff;
+        }
+        int alpha = static_cast<int>(r[3]) - t[3];
+        total += colour * (r[3] / 255.0) + alpha * alpha;
+    }
+    return total;
+}
+
+// Candidates that no other candidate beats on both size and error, smallest first
+std::vector<BudgetCandidate> paretoCandidates(std::vector<BudgetCandidate> candidates) {
+    std::stable_sort(candidates.begin(), candidates.end(), [](const BudgetCandidate& a, const BudgetCandidate& b) {
+        return a.bytes != b.bytes ? a.bytes < b.bytes : a.error < b.error;
+    });
+    std::vector<BudgetCandidate> front;
+    for (auto& candidate : candidates) {
+        if (front.empty() || candidate.error < front.back().error) {
+            front.push_back(std::move(candidate));
+        }
+    }
+    return front;
+}
+
+// Indices into a Pareto front forming its lower convex hull; stepping down the
+// hull gives up the least error per byte saved
+std::vector<size_t> convexHull(const std::vector<BudgetCandidate>& front) {
+    std::vector<size_t> hull;
+    for (size_t i = 0; i < front.size(); i++) {
+        while (hull.size() >= 2) {
+            const BudgetCandidate& a = front[hull[hull.size() - 2]];
+            const BudgetCandidate& b = front[hull.back()];
+            const BudgetCandidate& c = front[i];
+            double cross = (static_cast<double>(b.bytes) - a.bytes) * (c.error - a.error) -
+                           (b.error - a.error) * (static_cast<double>(c.bytes) - a.bytes);
+            if (cross > 0.0) {
+                break;
+            }
+            hull.pop_back();
+        }
+        hull.push_back(i);
+    }
+    return hull;
+}
+
+} // namespace
+
+BudgetPlan TextureConverter::optimizeForBudget(
+    const std::vector<ImageView>& images,
+    const BudgetOptions& options) {
+    
+    BudgetPlan plan;
+    for (const auto& image : images) {
+        if (!image.rgba || image.width == 0 || image.height == 0) {
+            return plan;
+        }
+    }
+    
+    // One task per image and downscale level; every format is tried within a task
+    struct Task {
+        size_t image;
+        uint32_t level;
+    };
+    std::vector<Task> tasks;
+    for (size_t i = 0; i < images.size(); i++) {
+        for (uint32_t level = 0; level <= options.maxDownscaleLevels && level < 32; level++) {
+            uint32_t width = std::max(1u, images[i].width >> level);
+            uint32_t height = std::max(1u, images[i].height >> level);
+            if (level > 0) {
+                // Stop at the size limit, or once a 1x1 image has nothing left to halve
+                bool belowLimit = width < options.minDimension || height < options.minDimension;
+                bool wasPixel = (std::max(images[i].width, images[i].height) >> (level - 1)) <= 1;
+                if (belowLimit || wasPixel) {
+                    break;
+                }
+            }
+            tasks.push_back({ i, level });
+        }
+    }
+    
+    std::vector<std::vector<BudgetCandidate>> results(tasks.size());
+    ScopedOpenMPThreads threads(options.threadCount);
+    const int64_t taskCount = static_cast<int64_t>(tasks.size());
+    
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int64_t n = 0; n < taskCount; n++) {
+        const Task& task = tasks[static_cast<size_t>(n)];
+        const ImageView& image = images[task.image];
+        const size_t originalPixels = static_cast<size_t>(image.width) * image.height;
+        const uint32_t width = std::max(1u, image.width >> task.level);
+        const uint32_t height = std::max(1u, image.height >> task.level);
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+        
+        std::vector<uint8_t> reducedStorage;
+        const uint8_t* reduced = image.rgba;
+        if (task.level > 0) {
+            reducedStorage.resize(pixelCount * 4);
+            resizeRGBA(image.rgba, image.width, image.height, reducedStorage.data(), width, height, options.filter);
+            reduced = reducedStorage.data();
+        }
+        
+        const TextureAnalysis analysis = analyzeTexture(reduced, width, height);
+        std::vector<FormatChoice> formats = lossyFormats(analysis, width, height, options.allowDXT,
+                                                         options.allowLowDepth, options.allowPalette);
+        formats.push_back(losslessFormat(analysis, pixelCount));
+        
+        std::vector<uint8_t> enlarged(task.level > 0 ? originalPixels * 4 : 0);
+        for (auto& format : formats) {
+            const bool lossless = format.paletteSize == 0 && format.compression == Compression::NONE &&
+                                  (format.rasterFormat == RasterFormat::B8G8R8 ||
+                                   format.rasterFormat == RasterFormat::B8G8R8A8);
+            std::unique_ptr<uint8_t[]> decoded;
+            if (!lossless) {
+                decoded = encodeRoundTrip(reduced, width, height, format, analysis, options.profile,
+                                          options.paletteOptions, DitherMode::None);
+                if (!decoded) {
+                    continue;
+                }
+                format.metrics = measureQuality(reduced, decoded.get(), width, height);
+                format.psnr = alphaWeightedPsnr(reduced, decoded.get(), pixelCount);
+            }
+            const uint8_t* result = lossless ? reduced : decoded.get();
+            
+            // Error is judged at the original size, so detail lost to downscaling counts
+            if (task.level > 0) {
+                resizeRGBA(result, width, height, enlarged.data(), image.width, image.height, options.filter);
+                result = enlarged.data();
+            }
+            
+            BudgetCandidate candidate;
+            candidate.format = format;
+            candidate.downscaleLevels = task.level;
+            candidate.width = width;
+            candidate.height = height;
+            candidate.bytes = storedBytes(format, width, height, options.includeMipmaps);
+            candidate.error = budgetError(image.rgba, result, originalPixels);
+            results[static_cast<size_t>(n)].push_back(std::move(candidate));
+        }
+    }
+    
+    std::vector<std::vector<BudgetCandidate>> fronts(images.size());
+    {
+        std::vector<std::vector<BudgetCandidate>> perImage(images.size());
+        for (size_t n = 0; n < tasks.size(); n++) {
+            for (auto& candidate : results[n]) {
+                perImage[tasks[n].image].push_back(std::move(candidate));
+            }
+        }
+        for (size_t i = 0; i < images.size(); i++) {
+            fronts[i] = paretoCandidates(std::move(perImage[i]));
+        }
+    }
+    
+    // Start every image at its best quality, then repeatedly take the hull step
+    // that gives up the least error per byte until the total fits
+    std::vector<std::vector<size_t>> hulls(images.size());
+    std::vector<size_t> hullPosition(images.size());
+    std::vector<size_t> chosen(images.size());
+    size_t total = 0;
+    for (size_t i = 0; i < images.size(); i++) {
+        hulls[i] = convexHull(fronts[i]);
+        hullPosition[i] = hulls[i].size() - 1;
+        chosen[i] = hulls[i].back();
+        total += fronts[i][chosen[i]].bytes;
+    }
+    
+    using Step = std::pair<double, size_t>;  // Error added per byte saved, image
+    std::priority_queue<Step, std::vector<Step>, std::greater<Step>> steps;
+    auto pushStep = [&](size_t i) {
+        if (hullPosition[i] == 0) {
+            return;
+        }
+        const BudgetCandidate& current = fronts[i][hulls[i][hullPosition[i]]];
+        const BudgetCandidate& smaller = fronts[i][hulls[i][hullPosition[i] - 1]];
+        steps.push({ (smaller.error - current.error) / static_cast<double>(current.bytes - smaller.bytes), i });
+    };
+    for (size_t i = 0; i < images.size(); i++) {
+        pushStep(i);
+    }
+    while (total > options.budgetBytes && !steps.empty()) {
+        size_t i = steps.top().second;
+        steps.pop();
+        size_t previous = chosen[i];
+        hullPosition[i]--;
+        chosen[i] = hulls[i][hullPosition[i]];
+        total -= fronts[i][previous].bytes - fronts[i][chosen[i]].bytes;
+        pushStep(i);
+    }
+    
+    // The last step usually overshoots; spend what is left on the upgrades,
+    // on or off the hull, that remove the most error
+    if (total <= options.budgetBytes) {
+        for (;;) {
+            double bestGain = 0.0;
+            size_t bestImage = 0, bestIndex = 0;
+            for (size_t i = 0; i < images.size(); i++) {
+                const BudgetCandidate& current = fronts[i][chosen[i]];
+                size_t limit = current.bytes + (options.budgetBytes - total);
+                for (size_t k = chosen[i] + 1; k < fronts[i].size() && fronts[i][k].bytes <= limit; k++) {
+                    double gain = current.error - fronts[i][k].error;
+                    if (gain > bestGain) {
+                        bestGain = gain;
+                        bestImage = i;
+                        bestIndex = k;
+                    }
+                }
+            }
+            if (bestGain <= 0.0) {
+                break;
+            }
+            total += fronts[bestImage][bestIndex].bytes - fronts[bestImage][chosen[bestImage]].bytes;
+            chosen[bestImage] = bestIndex;
+        }
+    }
+    
+    for (size_t i = 0; i < images.size(); i++) {
+        plan.choices.push_back(fronts[i][chosen[i]]);
+        plan.totalError += fronts[i][chosen[i]].error;
+    }
+    plan.totalBytes = total;
+    plan.withinBudget = total <= options.budgetBytes;
+    return plan;
+}
+
+bool TextureConverter::applyBudgetCandidate(
+    Texture& texture,
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    const BudgetCandidate& candidate,
+    const BudgetOptions& options,
+    const CompressionProfile& profile) {
+    
+    if (!rgbaData || width == 0 || height == 0 || candidate.width == 0 || candidate.height == 0) {
+        return false;
+    }
+    
+    std::vector<uint8_t> reduced(static_cast<size_t>(candidate.width) * candidate.height * 4);
+    if (!resizeRGBA(rgbaData, width, height, reduced.data(), candidate.width, candidate.height, options.filter)) {
+        return false;
+    }
+    
+    MipmapOptions mipOptions;
+    mipOptions.filter = MipmapFilter::Kaiser;
+    mipOptions.maxLevels = options.includeMipmaps ? 0 : 1;
+    auto levels = generateMipmaps(reduced.data(), candidate.width, candidate.height, mipOptions);
+    if (levels.empty()) {
+        return false;
+    }
+    
+    const FormatChoice& format = candidate.format;
+    std::vector<MipmapLevel> mipmaps;
+    std::vector<uint8_t> palette;
+    
+    if (format.compression != Compression::NONE) {
+        std::vector<CompressionJob> jobs;
+        for (const auto& image : levels) {
+            jobs.push_back({ image.rgba.data(), image.width, image.height, format.compression, profile });
+        }
+        auto compressed = compressBatch(jobs, options.threadCount);
+        for (size_t level = 0; level < levels.size(); level++) {
+            if (compressed[level].empty()) {
+                return false;
+            }
+            MipmapLevel mipmap;
+            Texture::getMipmapDimensions(candidate.width, candidate.height, static_cast<uint32_t>(level),
+                                         format.compression, mipmap.width, mipmap.height);
+            mipmap.dataSize = static_cast<uint32_t>(compressed[level].size());
+            mipmap.data = std::move(compressed[level]);
+            mipmaps.push_back(std::move(mipmap));
+        }
+    } else if (format.paletteSize > 0) {
+        std::vector<ImageView> views;
+        for (const auto& image : levels) {
+            views.push_back({ image.rgba.data(), image.width, image.height });
+        }
+        std::vector<std::vector<uint8_t>> indices;
+        if (!generateSharedPalette(views, format.paletteSize, palette, indices, options.paletteOptions)) {
+            return false;
+        }
+        for (size_t level = 0; level < levels.size(); level++) {
+            MipmapLevel mipmap;
+            mipmap.width = levels[level].width;
+            mipmap.height = levels[level].height;
+            mipmap.dataSize = static_cast<uint32_t>(indices[level].size());
+            mipmap.data = std::move(indices[level]);
+            mipmaps.push_back(std::move(mipmap));
+        }
+    } else {
+        const uint32_t pixelSize = getUncompressedPixelSize(format.rasterFormat);
+        for (const auto& image : levels) {
+            MipmapLevel mipmap;
+            mipmap.width = image.width;
+            mipmap.height = image.height;
+            mipmap.data.resize(static_cast<size_t>(image.width) * image.height * pixelSize);
+            if (!encodeUncompressed(image.rgba.data(), image.width, image.height, format.rasterFormat,
+                                    mipmap.data.mutableData())) {
+                return false;
+            }
+            mipmap.dataSize = static_cast<uint32_t>(mipmap.data.size());
+            mipmaps.push_back(std::move(mipmap));
+        }
+    }
+    
+    uint32_t rasterFormat = static_cast<uint32_t>(format.rasterFormat);
+    if (mipmaps.size() > 1) {
+        rasterFormat |= static_cast<uint32_t>(RasterFormat::MIPMAP);
+    }
+    texture.clearMipmaps();
+    texture.setPalette(palette, format.paletteSize);
+    texture.setCompression(format.compression);
+    texture.setRasterFormat(static_cast<RasterFormat>(rasterFormat));
+    texture.setDepth(format.depth);
+    texture.setHasAlpha(formatHasAlpha(format.rasterFormat));
+    for (auto& mipmap : mipmaps) {
+        texture.addMipmap(std::move(mipmap));
+    }
+    return true;
+}
+
+size_t TextureConverter::getCompressedDataSize(uint32_t width, uint32_t height, Compression compression) {
+    int flags = 0;
+    switch (compression) {
+        case Compression::DXT1:
+            flags = squish::kDxt1;
+            break;
+        case Compression::DXT3:
+            flags = squish::kDxt3;
+            break;
+        case Compression::DXT5:
+            flags = squish::kDxt5;
+            break;
+        default:
+            return 0;
+    }
+    
+    return squish::GetStorageRequirements(static_cast<int>(width), static_cast<int>(height), flags);
+}
+
+RasterFormat TextureConverter::getDXTRasterFormat(Compression compression, bool hasAlpha) {
+    if (compression == Compression::DXT1) {
+        return hasAlpha ? RasterFormat::A1R5G5B5 : RasterFormat::R5G6B5;
+    }
+    return compression == Compression::DXT3 ? RasterFormat::R4G4B4A4 : RasterFormat::B8G8R8A8;
+}
+
+bool TextureConverter::generatePalette(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    uint32_t paletteSize,
+    std::vector<uint8_t>& palette,
+    std::vector<uint8_t>& indexedData,
+    const PaletteOptions& options) {
+    
+    if (!rgbaData || width == 0 || height == 0 || (paletteSize != 16 && paletteSize != 256)) {
+        return false;
+    }
+    
+    // Cached entries hold the palette followed by the indices
+    const size_t paletteBytes = static_cast<size_t>(paletteSize) * 4;
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    auto cache = currentCache();
+    CacheKey key;
+    if (cache) {
+        key = makePaletteCacheKey(rgbaData, width, height, paletteSize, options);
+        std::vector<uint8_t> cached;
+        if (cache->load(key, cached) && cached.size() == paletteBytes + pixelCount) {
+            palette.assign(cached.begin(), cached.begin() + paletteBytes);
+            indexedData.assign(cached.begin() + paletteBytes, cached.end());
+            return true;
+        }
+    }
+    
+    ScopedOpenMPThreads threads(options.threadCount);
+    
+    // Create libimagequant attributes
+    liq_attr* attr = createQuantizerAttributes(paletteSize, options);
+    if (!attr) {
+        return false;
+    }
+    
+    // Create image from RGBA data
+    liq_image* image = liq_image_create_rgba(attr, rgbaData, static_cast<int>(width), static_cast<int>(height), 0);
+    if (!image) {
+        liq_attr_destroy(attr);
+        return false;
+    }
+    
+    // Quantize the image
+    liq_result* result = nullptr;
+    if (liq_image_quantize(image, attr, &result) != LIQ_OK || !result) {
+        liq_image_destroy(image);
+        liq_attr_destroy(attr);
+        return false;
+    }
+    liq_set_dithering_level(result, std::clamp(options.ditheringLevel, 0.0f, 1.0f));
+    
+    // Get palette
+    copyQuantizedPalette(liq_get_palette(result), paletteSize, palette);
+    
+    // Remap image to indexed
+    indexedData.resize(width * height);
+    liq_write_remapped_image(result, image, indexedData.data(), width * height);
+    
+    // Cleanup
+    liq_result_destroy(result);
+    liq_image_destroy(image);
+    liq_attr_destroy(attr);
+    
+    if (cache) {
+        std::vector<uint8_t> entry(palette);
+        entry.insert(entry.end(), indexedData.begin(), indexedData.end());
+        cache->store(key, entry.data(), entry.size());
+    }
+    
+    return true;
+}
+
+bool TextureConverter::generateSharedPalette(
+    const std::vector<ImageView>& images,
+    uint32_t paletteSize,
+    std::vector<uint8_t>& palette,
+    std::vector<std::vector<uint8_t>>& indexedData,
+    const PaletteOptions& options) {
+    
+    if (images.empty() || (paletteSize != 16 && paletteSize != 256)) {
+        return false;
+    }
+    for (const auto& view : images) {
+        if (!view.rgba || view.width == 0 || view.height == 0) {
+            return false;
+        }
+    }
+    
+    ScopedOpenMPThreads threads(options.threadCount);
+    
+    liq_attr* attr = createQuantizerAttributes(paletteSize, options);
+    if (!attr) {
+        return false;
+    }
+    
+    liq_histogram* histogram = liq_histogram_create(attr);
+    if (!histogram) {
+        liq_attr_destroy(attr);
+        return false;
+    }
+    
+    // The images must outlive the result, they are remapped after quantisation
+    std::vector<liq_image*> liqImages;
+    liqImages.reserve(images.size());
+    
+    auto cleanup = [&](liq_result* result) {
+        if (result) {
+            liq_result_destroy(result);
+        }
+        for (liq_image* image : liqImages) {
+            liq_image_destroy(image);
+        }
+        liq_histogram_destroy(histogram);
+        liq_attr_destroy(attr);
+    };
+    
+    // One histogram across every image, so the expensive quantisation runs once
+    for (const auto& view : images) {
+        liq_image* image = liq_image_create_rgba(attr, view.rgba, static_cast<int>(view.width),
+                                                 static_cast<int>(view.height), 0);
+        if (!image) {
+            cleanup(nullptr);
+            return false;
+        }
+        liqImages.push_back(image);
+        
+        if (liq_histogram_add_image(histogram, attr, image) != LIQ_OK) {
+            cleanup(nullptr);
+            return false;
+        }
+    }
+    
+    liq_result* result = nullptr;
+    if (liq_histogram_quantize(histogram, attr, &result) != LIQ_OK || !result) {
+        cleanup(nullptr);
+        return false;
+    }
+    liq_set_dithering_level(result, std::clamp(options.ditheringLevel, 0.0f, 1.0f));
+    
+    // Take the palette before remapping: each remap may nudge its own copy of the
+    // colours, but never reorders them, so the indices stay valid for this palette
+    copyQuantizedPalette(liq_get_palette(result), paletteSize, palette);
+    
+    indexedData.resize(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        size_t pixelCount = static_cast<size_t>(images[i].width) * images[i].height;
+        indexedData[i].resize(pixelCount);
+        if (liq_write_remapped_image(result, liqImages[i], indexedData[i].data(), pixelCount) != LIQ_OK) {
+            cleanup(result);
+            return false;
+        }
+    }
+    
+    cleanup(result);
+    return true;
+}
+
+void TextureConverter::convertPaletteToRGBA(
+    const uint8_t* indexedData,
+    const uint8_t* palette,
+    uint32_t paletteSize,
+    uint32_t width,
+    uint32_t height,
+    uint8_t* output) {
+    
+    if (!indexedData || !palette || !output || width == 0 || height == 0 || paletteSize == 0) {
+        return;
+    }
+    
+    uint32_t lut[256];
+    buildPaletteLUT(palette, paletteSize, lut);
+    
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8) {
+        uint32_t px[8] = {
+            lut[indexedData[i + 0]], lut[indexedData[i + 1]],
+            lut[indexedData[i + 2]], lut[indexedData[i + 3]],
+            lut[indexedData[i + 4]], lut[indexedData[i + 5]],
+            lut[indexedData[i + 6]], lut[indexedData[i + 7]]
+        };
+        std::memcpy(output + i * 4, px, sizeof(px));
+    }
+    for (; i < pixelCount; i++) {
+        std::memcpy(output + i * 4, &lut[indexedData[i]], 4);
+    }
+}
+
+void TextureConverter::convertPalette4ToRGBA(
+    const uint8_t* packedData,
+    const uint8_t* palette,
+    uint32_t paletteSize,
+    uint32_t width,
+    uint32_t height,
+    uint8_t* output) {
     
-    if (!compressedData || width == 0 || height == 0) {
-        return nullptr;
+    if (!packedData || !palette || !output || width == 0 || height == 0 || paletteSize == 0) {
+        return;
     }
     
-    auto output = std::make_unique<uint8_t[]>(width * height * 4);
+    uint32_t lut[256];
+    buildPaletteLUT(palette, std::min(paletteSize, 16u), lut);
     
-    int flags = 0;
-    switch (compression) {
-        case Compression::DXT1:
-            flags = squish::kDxt1;
-            break;
-        case Compression::DXT3:
-            flags = squish::kDxt3;
-            break;
-        default:
-            return nullptr;
+    size_t rowBytes = (width + 1) / 2;
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* src = packedData + y * rowBytes;
+        uint8_t* dst = output + static_cast<size_t>(y) * width * 4;
+        uint32_t x = 0;
+        for (; x + 2 <= width; x += 2) {
+            uint8_t packed = src[x / 2];
+            uint32_t px[2] = { lut[packed & 0x0F], lut[packed >> 4] };
+            std::memcpy(dst + x * 4, px, sizeof(px));
+        }
+        if (x < width) {
+            std::memcpy(dst + x * 4, &lut[src[x / 2] & 0x0F], 4);
+        }
     }
-    
-    // Decompress using squish
-    squish::DecompressImage(output.get(), static_cast<int>(width), static_cast<int>(height), compressedData, flags);
-    
-    return output;
 }
 
-std::unique_ptr<uint8_t[]> TextureConverter::compressToDXT(
+std::vector<MipmapImage> TextureConverter::generateMipmaps(
     const uint8_t* rgbaData,
     uint32_t width,
     uint32_t height,
-    Compression compression,
-    float quality) {
+    const MipmapOptions& options) {
     
+    std::vector<MipmapImage> levels;
     if (!rgbaData || width == 0 || height == 0) {
-        return nullptr;
+        return levels;
     }
     
-    int flags = 0;
-    switch (compression) {
-        case Compression::DXT1:
-            flags = squish::kDxt1;
-            break;
-        case Compression::DXT3:
-            flags = squish::kDxt3;
-            break;
-        default:
-            return nullptr;
+    uint32_t levelCount = Texture::getFullMipmapCount(width, height);
+    if (options.maxLevels > 0) {
+        levelCount = std::min(levelCount, options.maxLevels);
     }
+    levels.reserve(levelCount);
     
-    // Use quality to select compression method
-    if (quality >= 0.5f) {
-        flags |= squish::kColourClusterFit;
-    } else {
-        flags |= squish::kColourRangeFit;
+    // Preprocessing leaves alpha alone, so coverage is the same before and after
+    float targetCoverage = 0.0f;
+    if (options.preserveAlphaCoverage) {
+        targetCoverage = computeAlphaCoverage(rgbaData, width, height, options.alphaReference);
     }
     
-    size_t compressedSize = getCompressedDataSize(width, height, compression);
-    if (compressedSize == 0) {
-        return nullptr;
-    }
+    MipmapImage base;
+    base.width = width;
+    base.height = height;
+    base.rgba.assign(rgbaData, rgbaData + static_cast<size_t>(width) * height * 4);
+    applyAlphaPreprocess(base.rgba.data(), width, height, options.alphaPreprocess);
+    levels.push_back(std::move(base));
     
-    auto compressedData = std::make_unique<uint8_t[]>(compressedSize);
+    // Each level is filtered from the previous unadjusted level, so coverage
+    // scaling does not compound down the chain
+    std::vector<uint8_t> previous;
+    const uint8_t* source = levels[0].rgba.data();
+    uint32_t sourceWidth = width;
+    uint32_t sourceHeight = height;
     
-    // Compress using squish
-    squish::CompressImage(rgbaData, static_cast<int>(width), static_cast<int>(height), compressedData.get(), flags);
+    for (uint32_t i = 1; i < levelCount; i++) {
+        MipmapImage level;
+        level.width = std::max(1u, sourceWidth / 2);
+        level.height = std::max(1u, sourceHeight / 2);
+        level.rgba.resize(static_cast<size_t>(level.width) * level.height * 4);
+        downsampleRGBA(source, sourceWidth, sourceHeight, options.filter, level.rgba.data(), options.gammaCorrect);
+        // Refill transparent pixels from this level's own visible edge
+        if (options.alphaPreprocess == AlphaPreprocess::Bleed) {
+            bleedAlpha(level.rgba.data(), level.width, level.height);
+        }
+        
+        if (options.preserveAlphaCoverage) {
+            previous = level.rgba;
+            scaleAlphaToCoverage(level.rgba.data(), level.width, level.height, options.alphaReference, targetCoverage);
+        } else {
+            previous.clear();
+        }
+        
+        levels.push_back(std::move(level));
+        const MipmapImage& added = levels.back();
+        source = previous.empty() ? added.rgba.data() : previous.data();
+        sourceWidth = added.width;
+        sourceHeight = added.height;
+    }
     
-    return compressedData;
+    return levels;
 }
 
-size_t TextureConverter::getCompressedDataSize(uint32_t width, uint32_t height, Compression compression) {
-    int flags = 0;
-    switch (compression) {
-        case Compression::DXT1:
-            flags = squish::kDxt1;
-            break;
-        case Compression::DXT3:
-            flags = squish::kDxt3;
-            break;
-        default:
-            return 0;
+void TextureConverter::downsampleRGBA(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    MipmapFilter filter,
+    uint8_t* output,
+    bool gammaCorrect) {
+    
+    if (!rgbaData || !output || width == 0 || height == 0) {
+        return;
     }
     
-    return squish::GetStorageRequirements(static_cast<int>(width), static_cast<int>(height), flags);
+    uint32_t outWidth = std::max(1u, width / 2);
+    uint32_t outHeight = std::max(1u, height / 2);
+    
+    if (filter != MipmapFilter::Box) {
+        downsampleFiltered(rgbaData, width, height, filter, output, outWidth, outHeight, gammaCorrect);
+    } else if (gammaCorrect) {
+        downsampleBoxGamma(rgbaData, width, height, output, outWidth, outHeight);
+    } else {
+        downsampleBox(rgbaData, width, height, output, outWidth, outHeight);
+    }
 }
 
-bool TextureConverter::generatePalette(
-    const uint8_t* rgbaData,
+uint32_t TextureConverter::roundToPowerOfTwo(uint32_t size, PowerOfTwoRounding rounding) {
+    if (size == 0 || rounding == PowerOfTwoRounding::None) {
+        return size;
+    }
+    uint32_t down = 1;
+    while (down <= size / 2) {
+        down *= 2;
+    }
+    if (down == size || rounding == PowerOfTwoRounding::Down || down == 0x80000000u) {
+        return down;
+    }
+    uint32_t up = down * 2;
+    if (rounding == PowerOfTwoRounding::Up) {
+        return up;
+    }
+    return (size - down < up - size) ? down : up;
+}
+
+void TextureConverter::getResizeDimensions(
     uint32_t width,
     uint32_t height,
-    uint32_t paletteSize,
-    std::vector<uint8_t>& palette,
-    std::vector<uint8_t>& indexedData) {
+    uint32_t maxDimension,
+    PowerOfTwoRounding rounding,
+    uint32_t& outWidth,
+    uint32_t& outHeight) {
     
-    if (!rgbaData || width == 0 || height == 0 || (paletteSize != 16 && paletteSize != 256)) {
-        return false;
+    outWidth = width;
+    outHeight = height;
+    if (width == 0 || height == 0) {
+        return;
     }
     
-    // Create libimagequant attributes
-    liq_attr* attr = liq_attr_create();
-    if (!attr) {
-        return false;
+    if (maxDimension > 0 && std::max(width, height) > maxDimension) {
+        // Keep the aspect ratio, shrinking the longer side to the limit
+        double scale = static_cast<double>(maxDimension) / std::max(width, height);
+        outWidth = std::max(1u, static_cast<uint32_t>(std::lround(width * scale)));
+        outHeight = std::max(1u, static_cast<uint32_t>(std::lround(height * scale)));
     }
+    outWidth = roundToPowerOfTwo(outWidth, rounding);
+    outHeight = roundToPowerOfTwo(outHeight, rounding);
     
-    liq_set_max_colors(attr, static_cast<int>(paletteSize));
-    liq_set_speed(attr, 5); // Balance between speed and quality
-    
-    // Create image from RGBA data
-    liq_image* image = liq_image_create_rgba(attr, rgbaData, static_cast<int>(width), static_cast<int>(height), 0);
-    if (!image) {
-        liq_attr_destroy(attr);
-        return false;
+    // Rounding up must not take a side back over the limit
+    if (maxDimension > 0) {
+        while (outWidth > maxDimension && outWidth > 1) {
+            outWidth = rounding == PowerOfTwoRounding::None ? maxDimension : outWidth / 2;
+        }
+        while (outHeight > maxDimension && outHeight > 1) {
+            outHeight = rounding == PowerOfTwoRounding::None ? maxDimension : outHeight / 2;
+        }
     }
+}
+
+bool TextureConverter::resizeRGBA(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    uint8_t* output,
+    uint32_t outWidth,
+    uint32_t outHeight,
+    ResizeFilter filter,
+    bool gammaCorrect) {
     
-    // Quantize the image
-    liq_result* result = liq_quantize_image(attr, image);
-    if (!result) {
-        liq_image_destroy(image);
-        liq_attr_destroy(attr);
+    if (!rgbaData || !output || width == 0 || height == 0 || outWidth == 0 || outHeight == 0) {
         return false;
     }
     
-    // Get palette
-    const liq_palette* liq_pal = liq_get_palette(result);
-    palette.clear();
-    palette.reserve(paletteSize * 4);
-    
-    for (int i = 0; i < liq_pal->count; i++) {
-        palette.push_back(liq_pal->entries[i].r);
-        palette.push_back(liq_pal->entries[i].g);
-        palette.push_back(liq_pal->entries[i].b);
-        palette.push_back(liq_pal->entries[i].a);
+    if (width == outWidth && height == outHeight) {
+        std::memcpy(output, rgbaData, static_cast<size_t>(width) * height * 4);
+        return true;
     }
     
-    // Pad palette to requested size if needed
-    while (palette.size() < paletteSize * 4) {
-        palette.push_back(0);
-        palette.push_back(0);
-        palette.push_back(0);
-        palette.push_back(0);
+    // Opaque images skip the alpha weighting, which would not change them
+    const bool weightByAlpha = classifyAlpha(rgbaData, static_cast<size_t>(width) * height) != AlphaClass::Opaque;
+    
+    // Exact halving of an opaque image has a dedicated integer path
+    if (!weightByAlpha && filter == ResizeFilter::Box && outWidth == std::max(1u, width / 2) &&
+        outHeight == std::max(1u, height / 2) && width % 2 == 0 && height % 2 == 0) {
+        downsampleRGBA(rgbaData, width, height, MipmapFilter::Box, output, gammaCorrect);
+        return true;
     }
     
-    // Remap image to indexed
-    indexedData.resize(width * height);
-    liq_write_remapped_image(result, image, indexedData.data(), width * height);
+    resizeSeparable(rgbaData, width, height, output, outWidth, outHeight, filter, gammaCorrect, weightByAlpha);
+    return true;
+}
+
+float TextureConverter::computeAlphaCoverage(
+    const uint8_t* rgbaData,
+    uint32_t width,
+    uint32_t height,
+    uint8_t alphaReference) {
     
-    // Cleanup
-    liq_result_destroy(result);
-    liq_image_destroy(image);
-    liq_attr_destroy(attr);
+    if (!rgbaData || width == 0 || height == 0) {
+        return 0.0f;
+    }
     
-    return true;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    size_t covered = 0;
+    for (size_t i = 0; i < pixelCount; i++) {
+        covered += rgbaData[i * 4 + 3] >= alphaReference;
+    }
+    return static_cast<float>(covered) / static_cast<float>(pixelCount);
 }
 
-void TextureConverter::convertPaletteToRGBA(
-    const uint8_t* indexedData,
-    const uint8_t* palette,
-    uint32_t paletteSize,
+void TextureConverter::scaleAlphaToCoverage(
+    uint8_t* rgbaData,
     uint32_t width,
     uint32_t height,
-    uint8_t* output) {
+    uint8_t alphaReference,
+    float targetCoverage) {
     
-    if (!indexedData || !palette || !output || width == 0 || height == 0) {
+    if (!rgbaData || width == 0 || height == 0) {
         return;
     }
     
-    for (uint32_t y = 0; y < height; y++) {
-        for (uint32_t x = 0; x < width; x++) {
-            uint32_t index = indexedData[y * width + x];
-            if (index >= paletteSize) {
-                index = 0; // Safety check
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    uint32_t histogram[256] = {0};
+    for (size_t i = 0; i < pixelCount; i++) {
+        histogram[rgbaData[i * 4 + 3]]++;
+    }
+    
+    auto scaledAlpha = [](int alpha, float scale) {
+        return std::min(255, static_cast<int>(alpha * scale + 0.5f));
+    };
+    auto coverageAt = [&](float scale) {
+        size_t covered = 0;
+        for (int a = 0; a < 256; a++) {
+            if (scaledAlpha(a, scale) >= alphaReference) {
+                covered += histogram[a];
             }
+        }
+        return static_cast<float>(covered) / static_cast<float>(pixelCount);
+    };
+    
+    // Coverage grows monotonically with the scale, so bisect for the target
+    float low = 0.0f;
+    float high = 4.0f;
+    for (int i = 0; i < 20; i++) {
+        float mid = (low + high) * 0.5f;
+        if (coverageAt(mid) < targetCoverage) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    float scale = std::fabs(coverageAt(low) - targetCoverage) < std::fabs(coverageAt(high) - targetCoverage) ? low : high;
+    
+    uint8_t lut[256];
+    for (int a = 0; a < 256; a++) {
+        lut[a] = static_cast<uint8_t>(scaledAlpha(a, scale));
+    }
+    for (size_t i = 0; i < pixelCount; i++) {
+        rgbaData[i * 4 + 3] = lut[rgbaData[i * 4 + 3]];
+    }
+}
+
+namespace {
+
+// One pixel of an uncompressed raster format (format & 0x0F00) to RGBA8
+void decodeUncompressedPixel(uint32_t formatMask, const uint8_t* pixelData, uint8_t* outPixel) {
+    uint8_t r = 0, g = 0, b = 0, a = 255;
+    
+    switch (formatMask) {
+        case 0x0500: // B8G8R8A8
+            b = pixelData[0];
+            g = pixelData[1];
+            r = pixelData[2];
+            a = pixelData[3];
+            break;
             
-            uint32_t outIndex = (y * width + x) * 4;
-            uint32_t palIndex = index * 4;
+        case 0x0600: // B8G8R8
+            b = pixelData[0];
+            g = pixelData[1];
+            r = pixelData[2];
+            a = 255;
+            break;
             
-            output[outIndex + 0] = palette[palIndex + 0];  // R
-            output[outIndex + 1] = palette[palIndex + 1];  // G
-            output[outIndex + 2] = palette[palIndex + 2];  // B
-            output[outIndex + 3] = palette[palIndex + 3];  // A
+        // 16-bit channels are widened by bit replication so full
+        // intensity decodes to 255
+        case 0x0200: { // R5G6B5
+            uint16_t pixel = pixelData[0] | (pixelData[1] << 8);
+            r = expand5((pixel >> 11) & 0x1F);
+            g = expand6((pixel >> 5) & 0x3F);
+            b = expand5(pixel & 0x1F);
+            a = 255;
+            break;
+        }
+        
+        case 0x0100: { // A1R5G5B5
+            uint16_t pixel = pixelData[0] | (pixelData[1] << 8);
+            a = ((pixel >> 15) & 0x1) ? 255 : 0;
+            r = expand5((pixel >> 10) & 0x1F);
+            g = expand5((pixel >> 5) & 0x1F);
+            b = expand5(pixel & 0x1F);
+            break;
+        }
+        
+        case 0x0300: { // R4G4B4A4, stored as D3DFMT_A4R4G4B4
+            uint16_t pixel = pixelData[0] | (pixelData[1] << 8);
+            a = ((pixel >> 12) & 0xF) * 17;
+            r = ((pixel >> 8) & 0xF) * 17;
+            g = ((pixel >> 4) & 0xF) * 17;
+            b = (pixel & 0xF) * 17;
+            break;
         }
+        
+        case 0x0400: // LUM8
+            r = g = b = pixelData[0];
+            a = 255;
+            break;
+            
+        default:
+            r = g = b = 0;
+            a = 255;
+            break;
     }
+    
+    outPixel[0] = r;
+    outPixel[1] = g;
+    outPixel[2] = b;
+    outPixel[3] = a;
 }
 
+} // namespace
+
 std::unique_ptr<uint8_t[]> TextureConverter::convertToRGBA8(
     const Texture& texture,
     size_t mipmapIndex) {
@@ -216,7 +3428,7 @@ std::unique_ptr<uint8_t[]> TextureConverter::convertToRGBA8(
     if (isPalette) {
         // Handle palette texture
         uint32_t paletteSize = texture.getPaletteSize();
-        const std::vector<uint8_t>& palette = texture.getPalette();
+        const SharedBuffer& palette = texture.getPalette();
         
         if (paletteSize == 0 || palette.empty() || palette.size() < paletteSize * 4) {
             // Invalid palette data - fill with black
@@ -224,11 +3436,22 @@ std::unique_ptr<uint8_t[]> TextureConverter::convertToRGBA8(
             return output;
         }
         
-        // For palette textures, mipmap.data contains only the indexed image data
+        // For palette textures, mipmap.data contains only the indexed image data.
+        // PAL4 is normally widened to one index per byte, but packed nibbles occur too.
         const uint8_t* indexedData = mipmap.data.data();
         const uint8_t* paletteData = palette.data();
+        size_t pixelCount = static_cast<size_t>(mipmap.width) * mipmap.height;
+        size_t packedSize = static_cast<size_t>((mipmap.width + 1) / 2) * mipmap.height;
+        bool isPal4 = (rasterFormat & 0x4000) != 0;
         
-        convertPaletteToRGBA(indexedData, paletteData, paletteSize, mipmap.width, mipmap.height, output.get());
+        if (mipmap.data.size() >= pixelCount) {
+            convertPaletteToRGBA(indexedData, paletteData, paletteSize, mipmap.width, mipmap.height, output.get());
+        } else if (isPal4 && mipmap.data.size() >= packedSize) {
+            convertPalette4ToRGBA(indexedData, paletteData, paletteSize, mipmap.width, mipmap.height, output.get());
+        } else {
+            // Truncated index data - fill with black
+            std::memset(output.get(), 0, pixelCount * 4);
+        }
     } else {
         // Convert based on compression
         switch (texture.getCompression()) {
@@ -238,6 +3461,9 @@ std::unique_ptr<uint8_t[]> TextureConverter::convertToRGBA8(
             case Compression::DXT3:
                 convertDXT3(mipmap.data.data(), mipmap.width, mipmap.height, output.get());
                 break;
+            case Compression::DXT5:
+                convertDXT5(mipmap.data.data(), mipmap.width, mipmap.height, output.get());
+                break;
             case Compression::NONE:
                 convertUncompressed(texture, mipmap, output.get());
                 break;
@@ -251,6 +3477,133 @@ std::unique_ptr<uint8_t[]> TextureConverter::convertToRGBA8(
     return output;
 }
 
+bool TextureConverter::decodeRegion(
+    const Texture& texture,
+    size_t mipmapIndex,
+    uint32_t x,
+    uint32_t y,
+    uint32_t regionWidth,
+    uint32_t regionHeight,
+    uint8_t* output,
+    size_t outputStride) {
+    
+    if (!output || mipmapIndex >= texture.getMipmapCount() || regionWidth == 0 || regionHeight == 0) {
+        return false;
+    }
+    
+    const auto& mipmap = texture.getMipmap(mipmapIndex);
+    if (x >= mipmap.width || y >= mipmap.height ||
+        regionWidth > mipmap.width - x || regionHeight > mipmap.height - y || mipmap.data.empty()) {
+        return false;
+    }
+    if (outputStride == 0) {
+        outputStride = static_cast<size_t>(regionWidth) * 4;
+    }
+    
+    const uint8_t* data = mipmap.data.data();
+    const size_t dataSize = mipmap.data.size();
+    uint32_t rasterFormat = static_cast<uint32_t>(texture.getRasterFormat());
+    bool isPalette = (rasterFormat & 0x2000) != 0 || (rasterFormat & 0x4000) != 0;
+    
+    if (isPalette) {
+        // Same fallbacks as convertToRGBA8: black for a bad palette or truncated indices
+        uint32_t paletteSize = texture.getPaletteSize();
+        const SharedBuffer& palette = texture.getPalette();
+        size_t pixelCount = static_cast<size_t>(mipmap.width) * mipmap.height;
+        size_t rowBytes = (mipmap.width + 1) / 2;
+        bool isPal4 = (rasterFormat & 0x4000) != 0;
+        bool widened = dataSize >= pixelCount;
+        bool packed = !widened && isPal4 && dataSize >= rowBytes * mipmap.height;
+        
+        uint32_t lut[256] = {};
+        if (paletteSize > 0 && palette.size() >= paletteSize * 4 && (widened || packed)) {
+            buildPaletteLUT(palette.data(), packed ? std::min(paletteSize, 16u) : paletteSize, lut);
+        } else {
+            for (uint32_t row = 0; row < regionHeight; row++) {
+                std::memset(output + row * outputStride, 0, static_cast<size_t>(regionWidth) * 4);
+            }
+            return true;
+        }
+        
+        for (uint32_t row = 0; row < regionHeight; row++) {
+            uint8_t* dst = output + row * outputStride;
+            if (widened) {
+                const uint8_t* src = data + static_cast<size_t>(y + row) * mipmap.width + x;
+                for (uint32_t col = 0; col < regionWidth; col++) {
+                    std::memcpy(dst + col * 4, &lut[src[col]], 4);
+                }
+            } else {
+                const uint8_t* src = data + static_cast<size_t>(y + row) * rowBytes;
+                for (uint32_t col = 0; col < regionWidth; col++) {
+                    uint32_t px = x + col;
+                    uint8_t index = (px & 1) ? (src[px / 2] >> 4) : (src[px / 2] & 0x0F);
+                    std::memcpy(dst + col * 4, &lut[index], 4);
+                }
+            }
+        }
+        return true;
+    }
+    
+    Compression compression = texture.getCompression();
+    if (compression == Compression::NONE) {
+        uint32_t formatMask = rasterFormat & 0x0F00;
+        uint32_t bpp = texture.getDepth() / 8;
+        if (bpp == 0) {
+            bpp = 4; // Default to 32-bit
+        }
+        if (dataSize < static_cast<size_t>(mipmap.width) * mipmap.height * bpp) {
+            return false;
+        }
+        for (uint32_t row = 0; row < regionHeight; row++) {
+            const uint8_t* src = data + (static_cast<size_t>(y + row) * mipmap.width + x) * bpp;
+            uint8_t* dst = output + row * outputStride;
+            for (uint32_t col = 0; col < regionWidth; col++) {
+                decodeUncompressedPixel(formatMask, src + col * bpp, dst + col * 4);
+            }
+        }
+        return true;
+    }
+    
+    int flags = 0;
+    switch (compression) {
+        case Compression::DXT1:
+            flags = squish::kDxt1;
+            break;
+        case Compression::DXT3:
+            flags = squish::kDxt3;
+            break;
+        case Compression::DXT5:
+            flags = squish::kDxt5;
+            break;
+        default:
+            return false;
+    }
+    if (dataSize < getCompressedDataSize(mipmap.width, mipmap.height, compression)) {
+        return false;
+    }
+    
+    // Decode each touched block and copy out the part inside the rectangle
+    const size_t bytesPerBlock = compression == Compression::DXT1 ? 8 : 16;
+    const uint32_t blocksPerRow = (mipmap.width + 3) / 4;
+    const uint32_t lastX = x + regionWidth - 1;
+    const uint32_t lastY = y + regionHeight - 1;
+    for (uint32_t by = y / 4; by <= lastY / 4; by++) {
+        for (uint32_t bx = x / 4; bx <= lastX / 4; bx++) {
+            uint8_t block[64];
+            squish::Decompress(block, data + (static_cast<size_t>(by) * blocksPerRow + bx) * bytesPerBlock, flags);
+            
+            uint32_t x0 = std::max(x, bx * 4), x1 = std::min(lastX, bx * 4 + 3);
+            uint32_t y0 = std::max(y, by * 4), y1 = std::min(lastY, by * 4 + 3);
+            for (uint32_t py = y0; py <= y1; py++) {
+                std::memcpy(output + (py - y) * outputStride + static_cast<size_t>(x0 - x) * 4,
+                            block + ((py - by * 4) * 4 + (x0 - bx * 4)) * 4,
+                            static_cast<size_t>(x1 - x0 + 1) * 4);
+            }
+        }
+    }
+    return true;
+}
+
 bool TextureConverter::canConvert(const Texture& texture) {
     // Check for palette textures
     uint32_t rasterFormat = static_cast<uint32_t>(texture.getRasterFormat());
@@ -259,10 +3612,11 @@ bool TextureConverter::canConvert(const Texture& texture) {
         return true;
     }
     
-    // Support uncompressed, DXT1/DXT3
+    // Support uncompressed, DXT1/DXT3/DXT5
     bool supported = texture.getCompression() == Compression::NONE ||
                      texture.getCompression() == Compression::DXT1 ||
-                     texture.getCompression() == Compression::DXT3;
+                     texture.getCompression() == Compression::DXT3 ||
+                     texture.getCompression() == Compression::DXT5;
     
     return supported;
 }
@@ -286,65 +3640,7 @@ void TextureConverter::convertUncompressed(
             const uint8_t* pixelData = mipmap.data.data() + (pixelIndex * bpp);
             uint8_t* outPixel = output + (pixelIndex * 4);
             
-            uint8_t r = 0, g = 0, b = 0, a = 255;
-            
-            switch (formatMask) {
-                case 0x0500: // B8G8R8A8
-                    b = pixelData[0];
-                    g = pixelData[1];
-                    r = pixelData[2];
-                    a = pixelData[3];
-                    break;
-                    
-                case 0x0600: // B8G8R8
-                    b = pixelData[0];
-                    g = pixelData[1];
-                    r = pixelData[2];
-                    a = 255;
-                    break;
-                    
-                case 0x0200: { // R5G6B5
-                    uint16_t pixel = pixelData[0] | (pixelData[1] << 8);
-                    r = ((pixel >> 11) & 0x1F) << 3;
-                    g = ((pixel >> 5) & 0x3F) << 2;
-                    b = (pixel & 0x1F) << 3;
-                    a = 255;
-                    break;
-                }
-                
-                case 0x0100: { // A1R5G5B5
-                    uint16_t pixel = pixelData[0] | (pixelData[1] << 8);
-                    a = ((pixel >> 15) & 0x1) ? 255 : 0;
-                    r = ((pixel >> 10) & 0x1F) << 3;
-                    g = ((pixel >> 5) & 0x1F) << 3;
-                    b = (pixel & 0x1F) << 3;
-                    break;
-                }
-                
-                case 0x0300: { // R4G4B4A4
-                    uint16_t pixel = pixelData[0] | (pixelData[1] << 8);
-                    r = ((pixel >> 12) & 0xF) << 4;
-                    g = ((pixel >> 8) & 0xF) << 4;
-                    b = ((pixel >> 4) & 0xF) << 4;
-                    a = (pixel & 0xF) << 4;
-                    break;
-                }
-                
-                case 0x0400: // LUM8
-                    r = g = b = pixelData[0];
-                    a = 255;
-                    break;
-                    
-                default:
-                    r = g = b = 0;
-                    a = 255;
-                    break;
-            }
-            
-            outPixel[0] = r;
-            outPixel[1] = g;
-            outPixel[2] = b;
-            outPixel[3] = a;
+            decodeUncompressedPixel(formatMask, pixelData, outPixel);
         }
     }
 }
@@ -373,4 +3669,53 @@ void TextureConverter::convertDXT3(
     }
 }
 
+void TextureConverter::convertDXT5(
+    const uint8_t* data,
+    uint32_t width,
+    uint32_t height,
+    uint8_t* output) {
+    
+    auto decompressed = decompressDXT(data, width, height, Compression::DXT5);
+    if (decompressed) {
+        std::memcpy(output, decompressed.get(), width * height * 4);
+    }
+}
+
+size_t FormatSelectionReport::getOriginalBytes() const {
+    size_t total = 0;
+    for (const auto& entry : entries) {
+        total += entry.originalBytes;
+    }
+    return total;
+}
+
+size_t FormatSelectionReport::getSelectedBytes() const {
+    size_t total = 0;
+    for (const auto& entry : entries) {
+        total += entry.selectedBytes;
+    }
+    return total;
+}
+
+int64_t FormatSelectionReport::getBytesSaved() const {
+    return static_cast<int64_t>(getOriginalBytes()) - static_cast<int64_t>(getSelectedBytes());
+}
+
+std::string FormatSelectionReport::toString() const {
+    std::string report;
+    char line[160];
+    for (const auto& entry : entries) {
+        std::snprintf(line, sizeof(line), "%-32s %-9s %10zu -> %10zu bytes  %6.1f dB\n",
+                      entry.textureName.c_str(), entry.formatName.c_str(),
+                      entry.originalBytes, entry.selectedBytes, entry.rgbPsnr);
+        report += line;
+    }
+    size_t original = getOriginalBytes();
+    double percent = original > 0 ? 100.0 * static_cast<double>(getBytesSaved()) / original : 0.0;
+    std::snprintf(line, sizeof(line), "Total: %zu -> %zu bytes, %lld saved (%.1f%%)\n",
+                  original, getSelectedBytes(), static_cast<long long>(getBytesSaved()), percent);
+    report += line;
+    return report;
+}
+
 } // namespace LibTXD
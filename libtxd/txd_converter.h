@@ -3,12 +3,251 @@
 
 #include "txd_texture.h"
 #include "txd_types.h"
+#include "txd_cache.h"
 #include <cstdint>
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace LibTXD {
 
+// DXT colour encoder tiers, fastest first
+enum class CompressionSpeed {
+    Realtime,    // Integer bounding-box endpoints, SIMD index selection
+    RangeFit,    // squish kColourRangeFit
+    ClusterFit,  // squish kColourClusterFit
+    IterativeClusterFit  // squish kColourIterativeClusterFit
+};
+
+// Alpha-aware preparation of RGBA8 pixels before encoding or filtering
+enum class AlphaPreprocess {
+    None,
+    Premultiply,  // Scale RGB by alpha; the result is stored premultiplied
+    Bleed         // Fill the RGB of fully transparent pixels from their nearest visible neighbours
+};
+
+// DXT compression profile: encoder tier plus squish's colour error options.
+// Implicitly constructible from a CompressionSpeed for the common case.
+struct CompressionProfile {
+    CompressionSpeed speed;
+    bool perceptualMetric;     // kColourMetricPerceptual instead of kColourMetricUniform
+    bool weightColourByAlpha;  // kWeightColourByAlpha, honoured by the cluster fits only
+    AlphaPreprocess alphaPreprocess = AlphaPreprocess::None;  // Applied to a copy of the input
+    
+    CompressionProfile(CompressionSpeed s = CompressionSpeed::ClusterFit,
+                       bool perceptual = true,
+                       bool weightByAlpha = false)
+        : speed(s), perceptualMetric(perceptual), weightColourByAlpha(weightByAlpha) {}
+    
+    // Named profiles, fastest first
+    static CompressionProfile realtime() { return CompressionProfile(CompressionSpeed::Realtime); }
+    static CompressionProfile rangeFit() { return CompressionProfile(CompressionSpeed::RangeFit); }
+    static CompressionProfile clusterFit() { return CompressionProfile(CompressionSpeed::ClusterFit); }
+    static CompressionProfile iterativeClusterFit() { return CompressionProfile(CompressionSpeed::IterativeClusterFit); }
+    static CompressionProfile uniform() { return CompressionProfile(CompressionSpeed::ClusterFit, false); }
+    // squish's default metric, which every profile above uses; named for call sites that rely on it
+    static CompressionProfile perceptual() { return CompressionProfile(CompressionSpeed::ClusterFit, true); }
+    
+    // Iteration builds favour turnaround, release builds favour quality
+    static CompressionProfile fastest() { return realtime(); }
+    static CompressionProfile best() { return CompressionProfile(CompressionSpeed::IterativeClusterFit, true); }
+    
+    bool operator==(const CompressionProfile& other) const {
+        return speed == other.speed &&
+               perceptualMetric == other.perceptualMetric &&
+               weightColourByAlpha == other.weightColourByAlpha &&
+               alphaPreprocess == other.alphaPreprocess;
+    }
+    bool operator!=(const CompressionProfile& other) const { return !(*this == other); }
+};
+
+// Measured cost and error of one compression profile on a given image
+struct ProfileBenchmark {
+    std::string name;
+    CompressionProfile profile;
+    double megapixelsPerSecond;  // Encode throughput
+    double rmse;                 // Root mean square error over RGB (and alpha for DXT3/DXT5)
+    double psnr;                 // Peak signal-to-noise ratio in dB, infinite when lossless
+};
+
+// Dithering applied when quantising to fewer bits per channel
+enum class DitherMode {
+    None,            // Round to nearest
+    Ordered,         // 4x4 Bayer matrix, position independent and vectorised
+    ErrorDiffusion   // Floyd-Steinberg, best gradients but serial
+};
+
+// One image of a compressBatch call
+struct CompressionJob {
+    const uint8_t* rgba;  // width * height * 4 bytes, must stay valid for the call
+    uint32_t width;
+    uint32_t height;
+    Compression compression;
+    CompressionProfile profile;
+};
+
+// Error of a decoded image against its RGBA8 source
+struct QualityMetrics {
+    double mse[4];          // Mean squared error per RGBA channel
+    double psnr[4];         // Per channel in dB, infinite when identical
+    double rgbMse;          // Mean over the three colour channels
+    double rgbPsnr;
+    double ssim;            // Mean SSIM of alpha-premultiplied luma, 1.0 when identical
+    double alphaSsim;       // Mean SSIM of the alpha channel
+    uint8_t maxError[4];    // Largest absolute difference per channel
+};
+
+// libimagequant settings used for palette generation
+struct PaletteOptions {
+    int speed = 5;                // 1 (slowest, best) to 10 (fastest)
+    int minQuality = 0;           // 0-100, quantisation fails if this cannot be met
+    int maxQuality = 100;         // 0-100, fewer colours are used once this is reached
+    float ditheringLevel = 1.0f;  // 0 disables Floyd-Steinberg dithering, 1 is full
+    int threadCount = 0;          // 0 uses every core; ignored when built without OpenMP
+};
+
+// Alpha content of an image
+enum class AlphaClass {
+    Opaque,   // Every alpha is 255
+    OneBit,   // Every alpha is 0 or 255
+    Smooth    // Intermediate alpha values present
+};
+
+// Pixel statistics used to choose a storage format
+struct TextureAnalysis {
+    AlphaClass alpha = AlphaClass::Opaque;
+    uint32_t colourCount = 0;  // Distinct RGBA values, saturating at 257
+    bool grayscale = true;     // R == G == B for every pixel
+};
+
+// Quality target and candidate set for selectFormat
+struct FormatSelectionOptions {
+    double minPsnr = 35.0;       // RGB PSNR in dB a candidate must reach, weighted by source alpha
+    double minAlphaPsnr = 30.0;  // Alpha PSNR in dB, checked unless the image is opaque
+    double minSsim = 0.95;       // Mean SSIM a candidate must reach
+    bool allowDXT = true;
+    bool allowPalette = true;
+    bool allowLowDepth = true;   // 16-bit formats, and LUM8 for opaque grayscale images
+    CompressionProfile profile = CompressionProfile::perceptual();
+    PaletteOptions paletteOptions;
+    DitherMode dither = DitherMode::None;  // Used when measuring the 16-bit formats
+};
+
+// Storage format chosen for one image
+struct FormatChoice {
+    std::string name;            // "DXT1", "DXT1a", "DXT3", "DXT5", "PAL4", "PAL8", "R5G6B5", ...
+    Compression compression = Compression::NONE;
+    RasterFormat rasterFormat = RasterFormat::DEFAULT;  // Base format, plus PAL4/PAL8 for palettes
+    uint32_t depth = 32;
+    uint32_t paletteSize = 0;    // 16 or 256 for palettes, else 0
+    size_t bytes = 0;            // Level 0 pixel data plus palette
+    double psnr = 0.0;           // Alpha-weighted RGB PSNR, as compared with minPsnr
+    QualityMetrics metrics = {}; // Error of the chosen format against the source
+};
+
+// Savings of automatic format selection over a dictionary
+struct FormatReportEntry {
+    std::string textureName;
+    std::string formatName;
+    size_t originalBytes;        // Size with the format that would otherwise have been used
+    size_t selectedBytes;        // Size with the selected format
+    double rgbPsnr;
+};
+
+struct FormatSelectionReport {
+    std::vector<FormatReportEntry> entries;
+    
+    size_t getOriginalBytes() const;
+    size_t getSelectedBytes() const;
+    // Negative when the selected formats are larger
+    int64_t getBytesSaved() const;
+    
+    // One line per texture followed by a total
+    std::string toString() const;
+};
+
+// Read-only view of an RGBA8 image (width * height * 4 bytes)
+struct ImageView {
+    const uint8_t* rgba;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Mipmap downsampling filters
+enum class MipmapFilter {
+    Box,      // 2x2 average, fastest
+    Kaiser,   // Kaiser-windowed sinc, sharp with little ringing
+    Lanczos   // Lanczos3, sharpest, can ring on hard edges
+};
+
+// Settings for mip chain generation
+struct MipmapOptions {
+    MipmapFilter filter = MipmapFilter::Box;
+    bool preserveAlphaCoverage = false;  // Keep alpha-test coverage of level 0 on every level
+    uint8_t alphaReference = 128;        // Alpha test reference used for coverage
+    uint32_t maxLevels = 0;              // 0 generates the full chain down to 1x1
+    bool gammaCorrect = false;           // Filter RGB in linear light, treating input as sRGB
+    AlphaPreprocess alphaPreprocess = AlphaPreprocess::None;  // Applied to level 0 before filtering;
+                                                              // Bleed is repeated on every level
+};
+
+// Resampling filters for arbitrary resizes
+enum class ResizeFilter {
+    Box,       // Area average when shrinking, nearest pixel when enlarging
+    Bilinear,  // Triangle filter
+    Bicubic,   // Catmull-Rom, sharper than bilinear
+    Lanczos3   // Sharpest, can ring on hard edges
+};
+
+// How resize dimensions snap to powers of two
+enum class PowerOfTwoRounding {
+    None,
+    Nearest,
+    Down,
+    Up
+};
+
+// One RGBA8 level of a generated mip chain
+struct MipmapImage {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> rgba;  // width * height * 4 bytes
+};
+
+// Settings for fitting a set of images into a memory budget
+struct BudgetOptions {
+    size_t budgetBytes = 0;              // Total for every image, palettes and mip levels included
+    uint32_t maxDownscaleLevels = 2;     // Most halvings any image may be given
+    uint32_t minDimension = 4;           // Sides are never halved below this
+    bool includeMipmaps = true;          // Count and build each image with a full mip chain
+    bool allowDXT = true;
+    bool allowPalette = true;
+    bool allowLowDepth = true;
+    ResizeFilter filter = ResizeFilter::Lanczos3;                 // Shrinks, and enlarges again for measuring
+    CompressionProfile profile = CompressionProfile::realtime();  // Encoder for the measuring passes
+    PaletteOptions paletteOptions;
+    int threadCount = 0;                 // 0 uses every core; ignored when built without OpenMP
+};
+
+// One way of storing an image, as considered by optimizeForBudget
+struct BudgetCandidate {
+    FormatChoice format;                 // Metrics are for the downscaled level 0
+    uint32_t downscaleLevels = 0;
+    uint32_t width = 0;                  // Size after downscaling
+    uint32_t height = 0;
+    size_t bytes = 0;                    // Stored size, mip chain included when includeMipmaps
+    double error = 0.0;                  // Squared error summed over the image at its original size,
+                                         // colour weighted by source alpha
+};
+
+// Result of optimizeForBudget
+struct BudgetPlan {
+    std::vector<BudgetCandidate> choices;  // One per input image, in input order
+    size_t totalBytes = 0;
+    double totalError = 0.0;
+    bool withinBudget = false;             // False when even the smallest candidates do not fit
+};
+
 // Utility class for texture conversion operations
 class TextureConverter {
 public:
@@ -28,12 +267,159 @@ public:
         uint32_t width,
         uint32_t height,
         Compression compression,
-        float quality = 1.0f
+        const CompressionProfile& profile = CompressionProfile()
+    );
+    
+    // Results of compressToDXT, compressBatch and generatePalette are looked up
+    // in and stored to this cache when one is set. Pass nullptr to disable.
+    static void setCompressionCache(std::shared_ptr<CompressionCache> cache);
+    static std::shared_ptr<CompressionCache> getCompressionCache();
+    
+    // Compress the image with every named profile and measure throughput and error
+    // weightColourByAlpha is applied to each profile. Returns an empty list on failure.
+    static std::vector<ProfileBenchmark> benchmarkProfiles(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        Compression compression,
+        bool weightColourByAlpha = false
+    );
+    
+    // Compare two RGBA8 images of the same size. SSIM uses 8x8 windows at a
+    // stride of 4 pixels; colour in transparent areas does not count against it.
+    static QualityMetrics measureQuality(
+        const uint8_t* reference,
+        const uint8_t* test,
+        uint32_t width,
+        uint32_t height
+    );
+    
+    // compressToDXT followed by measureQuality of the decoded result
+    // Returns nullptr on failure, otherwise the compressed data
+    static std::unique_ptr<uint8_t[]> compressAndMeasure(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        Compression compression,
+        QualityMetrics& metrics,
+        const CompressionProfile& profile = CompressionProfile()
+    );
+    
+    // Rewrite DXT blocks in another DXT format without decoding the image
+    // DXT3/DXT5 to DXT1 needs fully opaque alpha and returns nullptr otherwise.
+    // DXT1 to DXT3/DXT5 is exact except for three-colour blocks that use the
+    // midpoint colour, which are re-encoded from their decoded pixels. Between
+    // DXT3 and DXT5 colour is kept exactly and only the alpha block is re-encoded.
+    static std::unique_ptr<uint8_t[]> transcodeDXT(
+        const uint8_t* compressedData,
+        uint32_t width,
+        uint32_t height,
+        Compression from,
+        Compression to
+    );
+    
+    // Transcode every mip level of a DXT texture in place and update its
+    // compression, alpha flag and raster format. Returns false and leaves the
+    // texture unchanged if the texture cannot be transcoded.
+    static bool transcodeTexture(Texture& texture, Compression to);
+    
+    // Compress many images on a thread pool, splitting large images into bands
+    // of block rows. Output is byte-identical to compressToDXT and in job order;
+    // invalid or failed jobs yield an empty buffer. threadCount 0 uses the
+    // OpenMP default.
+    static std::vector<std::vector<uint8_t>> compressBatch(
+        const std::vector<CompressionJob>& jobs,
+        int threadCount = 0
+    );
+    
+    // Bytes per pixel of an uncompressed raster format (flag bits are ignored)
+    // Returns 0 for formats encodeUncompressed cannot write.
+    static uint32_t getUncompressedPixelSize(RasterFormat format);
+    
+    // Encode RGBA8 to B8G8R8A8, B8G8R8, R5G6B5, A1R5G5B5, R4G4B4A4 (stored as
+    // A4R4G4B4) or LUM8. Output must hold width * height * getUncompressedPixelSize
+    // bytes. Dithering applies to the 16-bit formats. Returns false if unsupported.
+    static bool encodeUncompressed(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        RasterFormat format,
+        uint8_t* output,
+        DitherMode dither = DitherMode::None
+    );
+    
+    // Classify alpha, count colours and detect grayscale in one pass
+    static TextureAnalysis analyzeTexture(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height
+    );
+    
+    // Channel kernels over pixelCount RGBA8 pixels, writing into caller buffers
+    // Alpha plane (pixelCount bytes)
+    static void extractAlpha(const uint8_t* rgbaData, size_t pixelCount, uint8_t* alpha);
+    // Replace every alpha with the matching byte of a plane, keeping RGB
+    static void insertAlpha(uint8_t* rgbaData, size_t pixelCount, const uint8_t* alpha);
+    // Packed RGB without alpha (pixelCount * 3 bytes)
+    static void stripAlpha(const uint8_t* rgbaData, size_t pixelCount, uint8_t* rgb);
+    // Rec. 601 luma plane (pixelCount bytes), for using an image as an alpha mask
+    static void extractLuminance(const uint8_t* rgbaData, size_t pixelCount, uint8_t* luminance);
+    // Alpha class alone; stops reading at the first intermediate value
+    static AlphaClass classifyAlpha(const uint8_t* rgbaData, size_t pixelCount);
+    
+    // Scale RGB by alpha in place, rounding to nearest; alpha is unchanged
+    static void premultiplyAlpha(uint8_t* rgbaData, size_t pixelCount);
+    // Inverse of premultiplyAlpha; RGB of fully transparent pixels is left as is
+    static void unpremultiplyAlpha(uint8_t* rgbaData, size_t pixelCount);
+    // Dilate colour into fully transparent pixels, one ring of neighbours at a
+    // time, so filtering and block encoding do not pull in stray RGB. Alpha and
+    // visible pixels are unchanged; images with no visible pixel are left as is.
+    static void bleedAlpha(uint8_t* rgbaData, uint32_t width, uint32_t height);
+    // Dispatch to premultiplyAlpha or bleedAlpha
+    static void applyAlphaPreprocess(uint8_t* rgbaData, uint32_t width, uint32_t height, AlphaPreprocess preprocess);
+    
+    // Pick the smallest format whose decoded result meets the quality target
+    // Candidates suited to the image's alpha are encoded smallest first and the
+    // first to pass wins; B8G8R8A8 (B8G8R8 when opaque) is the lossless fallback.
+    // Returns a choice with an empty name for invalid input.
+    static FormatChoice selectFormat(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        const FormatSelectionOptions& options = FormatSelectionOptions()
+    );
+    
+    // Choose a downscale level and format for every image so that the total
+    // size fits options.budgetBytes with the least total error. Each image is
+    // encoded and measured at every allowed size and format, in parallel; the
+    // choice is then made greedily along each image's size/error trade-off.
+    // Images of several dictionaries can be passed together to share one budget.
+    // Returns an empty plan if any image is invalid.
+    static BudgetPlan optimizeForBudget(
+        const std::vector<ImageView>& images,
+        const BudgetOptions& options
+    );
+    
+    // Rebuild a texture from its RGBA8 level 0 as a plan choice: shrink it,
+    // build the mip chain (level 0 only without includeMipmaps) and encode every
+    // level in the chosen format. Name, mask name, filter flags and platform are kept.
+    static bool applyBudgetCandidate(
+        Texture& texture,
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        const BudgetCandidate& candidate,
+        const BudgetOptions& options,
+        const CompressionProfile& profile = CompressionProfile::perceptual()
     );
     
     // Get compressed data size for a given format and dimensions
     static size_t getCompressedDataSize(uint32_t width, uint32_t height, Compression compression);
     
+    // Raster format RenderWare tags a DXT raster with: DXT1 is 565 (1555 with
+    // alpha), DXT3 is 4444 and DXT5 is 8888
+    static RasterFormat getDXTRasterFormat(Compression compression, bool hasAlpha);
+    
     // Generate palette from RGBA8 image data using libimagequant
     // Returns true on success, false on failure
     // paletteSize: 16 for PAL4, 256 for PAL8
@@ -43,7 +429,20 @@ public:
         uint32_t height,
         uint32_t paletteSize,
         std::vector<uint8_t>& palette,  // Output: RGBA palette (paletteSize * 4 bytes)
-        std::vector<uint8_t>& indexedData  // Output: Indexed image data (width * height bytes)
+        std::vector<uint8_t>& indexedData,  // Output: Indexed image data (width * height bytes)
+        const PaletteOptions& options = PaletteOptions()
+    );
+    
+    // Generate one palette shared by a set of RGBA8 images
+    // Builds a single histogram across all images, quantises it once and
+    // remaps every image against the result. indexedData[i] receives
+    // images[i].width * images[i].height indices. Returns false on failure.
+    static bool generateSharedPalette(
+        const std::vector<ImageView>& images,
+        uint32_t paletteSize,
+        std::vector<uint8_t>& palette,  // Output: RGBA palette (paletteSize * 4 bytes)
+        std::vector<std::vector<uint8_t>>& indexedData,  // Output: one index buffer per image
+        const PaletteOptions& options = PaletteOptions()
     );
     
     // Convert palette texture to RGBA8
@@ -56,6 +455,86 @@ public:
         uint8_t* output  // Output RGBA8 buffer (width * height * 4 bytes)
     );
     
+    // Convert packed 4-bit palette texture to RGBA8
+    // Each row is (width + 1) / 2 bytes, low nibble holds the left pixel
+    static void convertPalette4ToRGBA(
+        const uint8_t* packedData,
+        const uint8_t* palette,  // RGBA palette data
+        uint32_t paletteSize,
+        uint32_t width,
+        uint32_t height,
+        uint8_t* output  // Output RGBA8 buffer (width * height * 4 bytes)
+    );
+    
+    // Generate a mip chain from RGBA8 data, level 0 (a copy of the input) included
+    // Level n is max(1, width >> n) x max(1, height >> n) pixels; for DXT storage
+    // sizes see Texture::getMipmapDimensions. Returns an empty list on failure.
+    static std::vector<MipmapImage> generateMipmaps(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        const MipmapOptions& options = MipmapOptions()
+    );
+    
+    // Halve an RGBA8 image once with the given filter
+    // Output is max(1, width / 2) x max(1, height / 2) pixels. With gammaCorrect
+    // RGB is decoded from sRGB before filtering and re-encoded after; alpha is linear.
+    static void downsampleRGBA(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        MipmapFilter filter,
+        uint8_t* output,
+        bool gammaCorrect = false
+    );
+    
+    // Resample an RGBA8 image to any size with a separable filter
+    // Filter weights are cached per (size, filter) so repeated sizes are cheap.
+    // With gammaCorrect RGB is filtered in linear light; alpha is linear. RGB is
+    // weighted by alpha, so colour under transparent pixels stays out of visible ones.
+    // Output must hold outWidth * outHeight * 4 bytes. Returns false on invalid input.
+    static bool resizeRGBA(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        uint8_t* output,
+        uint32_t outWidth,
+        uint32_t outHeight,
+        ResizeFilter filter = ResizeFilter::Lanczos3,
+        bool gammaCorrect = false
+    );
+    
+    // Round a dimension to a power of two (0 stays 0)
+    static uint32_t roundToPowerOfTwo(uint32_t size, PowerOfTwoRounding rounding);
+    
+    // Target size for resizeRGBA: shrink so neither side exceeds maxDimension
+    // (0 for no limit) keeping the aspect ratio, then round each side
+    static void getResizeDimensions(
+        uint32_t width,
+        uint32_t height,
+        uint32_t maxDimension,
+        PowerOfTwoRounding rounding,
+        uint32_t& outWidth,
+        uint32_t& outHeight
+    );
+    
+    // Fraction of pixels whose alpha passes an alpha test against reference
+    static float computeAlphaCoverage(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        uint8_t alphaReference
+    );
+    
+    // Scale alpha so that computeAlphaCoverage matches the target coverage
+    static void scaleAlphaToCoverage(
+        uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        uint8_t alphaReference,
+        float targetCoverage
+    );
+    
     // Convert texture mipmap to RGBA8 format
     // Handles uncompressed, DXT compressed, and palette textures
     static std::unique_ptr<uint8_t[]> convertToRGBA8(
@@ -63,10 +542,44 @@ public:
         size_t mipmapIndex = 0
     );
     
+    // Decode a rectangle of one mip level to RGBA8, reading only the DXT blocks,
+    // palette indices or pixels it covers. Matches the same rectangle of
+    // convertToRGBA8. Rows of output are outputStride bytes apart (0 for
+    // regionWidth * 4). Returns false if the rectangle is empty or leaves the
+    // level, the format is unsupported or the level's data is truncated.
+    static bool decodeRegion(
+        const Texture& texture,
+        size_t mipmapIndex,
+        uint32_t x,
+        uint32_t y,
+        uint32_t regionWidth,
+        uint32_t regionHeight,
+        uint8_t* output,
+        size_t outputStride = 0
+    );
+    
     // Check if a texture format can be converted
     static bool canConvert(const Texture& texture);
     
 private:
+    // Helper: compressToDXT without the cache lookup
+    static std::unique_ptr<uint8_t[]> compressUncached(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        Compression compression,
+        const CompressionProfile& profile
+    );
+    
+    // Helper: Real-time DXT1/DXT3/DXT5 encoder used by CompressionSpeed::Realtime
+    static void compressRealtime(
+        const uint8_t* rgbaData,
+        uint32_t width,
+        uint32_t height,
+        Compression compression,
+        uint8_t* output
+    );
+    
     // Helper: Convert uncompressed texture data to RGBA8
     static void convertUncompressed(
         const Texture& texture,
@@ -89,6 +602,14 @@ private:
         uint32_t height,
         uint8_t* output
     );
+    
+    // Helper: Convert DXT5 compressed data
+    static void convertDXT5(
+        const uint8_t* data,
+        uint32_t width,
+        uint32_t height,
+        uint8_t* output
+    );
 };
 
 } // namespace LibTXD
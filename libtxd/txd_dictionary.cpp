@@ -1,5 +1,6 @@
 #include "txd_dictionary.h"
 #include "txd_types.h"
+#include "txd_converter.h"
 #include <fstream>
 #include <algorithm>
 #include <cstring>
@@ -19,6 +20,8 @@ TextureDictionary::TextureDictionary(TextureDictionary&& other) noexcept
     , textureMap(std::move(other.textureMap))
     , version(other.version)
     , gameVersion(other.gameVersion)
+    , arenaEnabled(other.arenaEnabled)
+    , arena(std::move(other.arena))
 {
 }
 
@@ -28,6 +31,8 @@ TextureDictionary& TextureDictionary::operator=(TextureDictionary&& other) noexc
         textureMap = std::move(other.textureMap);
         version = other.version;
         gameVersion = other.gameVersion;
+        arenaEnabled = other.arenaEnabled;
+        arena = std::move(other.arena);
     }
     return *this;
 }
@@ -102,6 +107,153 @@ void TextureDictionary::removeTexture(const std::string& name) {
 void TextureDictionary::clear() {
     textures.clear();
     textureMap.clear();
+    arena.reset();
+}
+
+namespace {
+
+bool sameTextureData(const Texture& a, const Texture& b) {
+    if (a.getPlatform() != b.getPlatform() || a.getFilterFlags() != b.getFilterFlags() ||
+        a.getRasterFormat() != b.getRasterFormat() || a.getDepth() != b.getDepth() ||
+        a.hasAlpha() != b.hasAlpha() || a.getCompression() != b.getCompression() ||
+        a.getPaletteSize() != b.getPaletteSize() || a.getPalette() != b.getPalette() ||
+        a.getMaskName() != b.getMaskName() || a.getMipmapCount() != b.getMipmapCount()) {
+        return false;
+    }
+    for (uint32_t level = 0; level < a.getMipmapCount(); level++) {
+        const MipmapLevel& mipA = a.getMipmap(level);
+        const MipmapLevel& mipB = b.getMipmap(level);
+        if (mipA.width != mipB.width || mipA.height != mipB.height || mipA.data != mipB.data) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t textureDataBytes(const Texture& texture) {
+    size_t bytes = texture.getPalette().size();
+    for (uint32_t level = 0; level < texture.getMipmapCount(); level++) {
+        bytes += texture.getMipmap(level).data.size();
+    }
+    return bytes;
+}
+
+// Indices of textures with identical data, each group in dictionary order
+std::vector<std::vector<size_t>> groupDuplicateTextures(const std::vector<Texture>& textures) {
+    std::unordered_map<uint64_t, std::vector<size_t>> candidates;
+    std::vector<uint64_t> hashes(textures.size());
+    for (size_t i = 0; i < textures.size(); i++) {
+        hashes[i] = textures[i].getContentHash();
+        candidates[hashes[i]].push_back(i);
+    }
+    
+    std::vector<std::vector<size_t>> groups;
+    std::vector<bool> grouped(textures.size(), false);
+    for (size_t i = 0; i < textures.size(); i++) {
+        if (grouped[i]) {
+            continue;
+        }
+        std::vector<size_t> group{i};
+        for (size_t other : candidates[hashes[i]]) {
+            if (other > i && !grouped[other] && sameTextureData(textures[i], textures[other])) {
+                group.push_back(other);
+                grouped[other] = true;
+            }
+        }
+        if (group.size() > 1) {
+            groups.push_back(std::move(group));
+        }
+    }
+    return groups;
+}
+
+} // namespace
+
+size_t TextureDictionary::shareDuplicateData() {
+    // Buffers seen so far, by content hash; collisions are resolved by comparing bytes
+    std::unordered_multimap<uint64_t, const SharedBuffer*> seen;
+    size_t saved = 0;
+    
+    for (auto& texture : textures) {
+        for (uint32_t level = 0; level < texture.getMipmapCount(); level++) {
+            SharedBuffer& data = texture.getMipmap(level).data;
+            if (data.empty()) {
+                continue;
+            }
+            
+            uint64_t hash = data.hash();
+            bool shared = false;
+            auto range = seen.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (*it->second == data) {
+                    if (!data.sharesStorageWith(*it->second)) {
+                        // An arena slice is only freed with the whole arena
+                        if (!data.isArenaBacked()) {
+                            saved += data.size();
+                        }
+                        data = *it->second;
+                    }
+                    shared = true;
+                    break;
+                }
+            }
+            if (!shared) {
+                seen.emplace(hash, &data);
+            }
+        }
+    }
+    return saved;
+}
+
+uint64_t TextureDictionary::getContentHash() const {
+    uint64_t hash = hashData(&version, sizeof(version));
+    for (const auto& texture : textures) {
+        hash = hashData(texture.getName().data(), texture.getName().size() + 1, hash);
+        hash = hashData(texture.getMaskName().data(), texture.getMaskName().size() + 1, hash);
+        const uint64_t content = texture.getContentHash();
+        hash = hashData(&content, sizeof(content), hash);
+    }
+    return hash;
+}
+
+std::vector<DuplicateGroup> TextureDictionary::findDuplicateTextures() const {
+    std::vector<DuplicateGroup> groups;
+    for (const auto& indices : groupDuplicateTextures(textures)) {
+        DuplicateGroup group;
+        for (size_t index : indices) {
+            group.names.push_back(textures[index].getName());
+        }
+        group.bytes = textureDataBytes(textures[indices.front()]);
+        groups.push_back(std::move(group));
+    }
+    return groups;
+}
+
+size_t TextureDictionary::removeDuplicateTextures() {
+    std::vector<bool> remove(textures.size(), false);
+    size_t removed = 0;
+    for (const auto& indices : groupDuplicateTextures(textures)) {
+        for (size_t i = 1; i < indices.size(); i++) {
+            remove[indices[i]] = true;
+            removed++;
+        }
+    }
+    if (removed == 0) {
+        return 0;
+    }
+    
+    size_t kept = 0;
+    for (size_t i = 0; i < textures.size(); i++) {
+        if (!remove[i]) {
+            if (kept != i) {
+                textures[kept] = std::move(textures[i]);
+            }
+            kept++;
+        }
+    }
+    textures.erase(textures.begin() + kept, textures.end());
+    rebuildTextureMap();
+    return removed;
 }
 
 bool TextureDictionary::load(const std::string& filepath) {
@@ -129,6 +281,90 @@ bool TextureDictionary::save(std::ostream& stream) const {
     return writeToStream(stream);
 }
 
+namespace {
+
+// TEXDICTIONARY header, STRUCT header with the texture count, EXTENSION header
+const size_t kDictionaryOverhead = 12 + 12 + 4 + 12;
+
+// Arena room per texture beyond its payload: shared_ptr control blocks and
+// alignment for a palette and up to 15 mip levels. Textures past the estimate
+// fall back to the heap.
+const size_t kArenaBytesPerTexture = 16 * 128;
+
+// Bytes from the current position to the end of the stream
+size_t remainingStreamBytes(std::istream& stream) {
+    std::streampos current = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    std::streampos end = stream.tellg();
+    stream.seekg(current, std::ios::beg);
+    return end > current ? static_cast<size_t>(end - current) : 0;
+}
+
+} // namespace
+
+size_t TextureDictionary::getSerializedSize() const {
+    size_t size = kDictionaryOverhead;
+    for (const auto& texture : textures) {
+        size += texture.getD3DSize();
+    }
+    return size;
+}
+
+size_t TextureDictionary::estimateSerializedSize(const ConversionTarget& target) const {
+    if (target.platform != Platform::D3D8 && target.platform != Platform::D3D9) {
+        return 0;
+    }
+    
+    const uint32_t formatFlags = static_cast<uint32_t>(target.rasterFormat);
+    uint32_t paletteBytes = 0;
+    uint32_t pixelSize = 0;
+    if (target.compression == Compression::NONE) {
+        if (formatFlags & static_cast<uint32_t>(RasterFormat::PAL8)) {
+            paletteBytes = 256 * 4;
+            pixelSize = 1;
+        } else if (formatFlags & static_cast<uint32_t>(RasterFormat::PAL4)) {
+            paletteBytes = 16 * 4;
+            pixelSize = 1;  // Indices are stored one per byte
+        } else {
+            pixelSize = TextureConverter::getUncompressedPixelSize(target.rasterFormat);
+        }
+        if (pixelSize == 0) {
+            return 0;
+        }
+    }
+    
+    size_t size = kDictionaryOverhead;
+    for (const auto& texture : textures) {
+        if (texture.getMipmapCount() == 0) {
+            size += texture.getD3DSize();
+            continue;
+        }
+        const uint32_t width = texture.getMipmap(0).width;
+        const uint32_t height = texture.getMipmap(0).height;
+        
+        uint32_t levels = texture.getMipmapCount();
+        if (target.mipmaps == MipmapPolicy::BaseOnly) {
+            levels = 1;
+        } else if (target.mipmaps == MipmapPolicy::FullChain) {
+            levels = Texture::getFullMipmapCount(width, height);
+            if (target.maxMipmapLevels > 0) {
+                levels = std::min(levels, target.maxMipmapLevels);
+            }
+        }
+        
+        size_t mipmapBytes = 0;
+        for (uint32_t level = 0; level < levels; level++) {
+            uint32_t levelWidth, levelHeight;
+            Texture::getMipmapDimensions(width, height, level, target.compression, levelWidth, levelHeight);
+            mipmapBytes += target.compression != Compression::NONE
+                ? TextureConverter::getCompressedDataSize(levelWidth, levelHeight, target.compression)
+                : static_cast<size_t>(levelWidth) * levelHeight * pixelSize;
+        }
+        size += Texture::getD3DSize(paletteBytes, levels, mipmapBytes);
+    }
+    return size;
+}
+
 bool TextureDictionary::readFromStream(std::istream& stream) {
     ChunkHeader header;
     if (!header.read(stream)) {
@@ -146,6 +382,9 @@ bool TextureDictionary::readFromStream(std::istream& stream) {
     size_t sectionStart = stream.tellg();
     size_t sectionEnd = sectionStart + header.length;
     
+    // With the arena, duplicates are shared as they are read so they never take arena space
+    std::unique_ptr<PayloadPool> pool;
+    
     // Read child sections
     while (stream.tellg() < static_cast<std::streampos>(sectionEnd) && stream.good()) {
         ChunkHeader childHeader;
@@ -165,6 +404,14 @@ bool TextureDictionary::readFromStream(std::istream& stream) {
             // Skip unknown field (2 bytes)
             stream.seekg(2, std::ios::cur);
             
+            textures.reserve(textureCount);
+            if (arenaEnabled) {
+                // Payloads cannot be larger than the rest of the section
+                size_t payload = std::min(sectionEnd - childStart, remainingStreamBytes(stream));
+                arena = std::make_shared<BufferArena>(payload + textureCount * kArenaBytesPerTexture);
+                pool = std::make_unique<PayloadPool>(arena);
+            }
+            
             // Skip to end of struct
             stream.seekg(childEnd, std::ios::beg);
         } else if (childHeader.type == ChunkType::TEXTURENATIVE) {
@@ -173,7 +420,7 @@ bool TextureDictionary::readFromStream(std::istream& stream) {
             stream.seekg(childStart - 12, std::ios::beg);
             
             Texture texture;
-            if (texture.readD3D(stream)) {
+            if (texture.readD3D(stream, pool.get())) {
                 addTexture(std::move(texture));
             }
             // Ensure we're at the end of the section
@@ -190,6 +437,10 @@ bool TextureDictionary::readFromStream(std::istream& stream) {
     // Detect game version after reading textures (so we can use platform info)
     gameVersion = detectGameVersion(version);
     
+    if (!pool) {
+        shareDuplicateData();
+    }
+    
     return true;
 }
 
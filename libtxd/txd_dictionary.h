@@ -12,6 +12,28 @@
 
 namespace LibTXD {
 
+// Textures whose stored data is identical: same format, palette and mip levels
+struct DuplicateGroup {
+    std::vector<std::string> names;  // In dictionary order; the first is the one kept by removeDuplicateTextures
+    size_t bytes = 0;                // Mip and palette bytes of one copy
+};
+
+// Which mip levels a converted texture keeps
+enum class MipmapPolicy {
+    Keep,       // As many levels as the texture has now
+    BaseOnly,   // Level 0 only
+    FullChain   // Every level down to 1x1; DXT levels below 4x4 are stored as one block
+};
+
+// Format a dictionary would be converted to, for estimateSerializedSize
+struct ConversionTarget {
+    Compression compression = Compression::DXT1;
+    RasterFormat rasterFormat = RasterFormat::B8G8R8A8;  // Uncompressed target; PAL4/PAL8 flags add a palette
+    MipmapPolicy mipmaps = MipmapPolicy::Keep;
+    uint32_t maxMipmapLevels = 0;                         // Caps FullChain, 0 for no limit
+    Platform platform = Platform::D3D9;                   // D3D8 and D3D9 natives have the same layout
+};
+
 // Texture Dictionary class - represents a TXD file
 class TextureDictionary {
 public:
@@ -37,6 +59,33 @@ public:
     void removeTexture(const std::string& name);
     void clear();
     
+    // Hash of the version and every texture including names; equal for
+    // dictionaries that save identically. Reuses the cached mip hashes.
+    uint64_t getContentHash() const;
+    
+    // Duplicate data
+    // Lets identical mip levels share one buffer; load does this automatically.
+    // Returns the number of bytes no longer held in memory twice. Arena-backed
+    // bytes stay allocated until the arena goes, so they are not counted.
+    size_t shareDuplicateData();
+    // Groups of two or more textures that would be written identically apart from name
+    std::vector<DuplicateGroup> findDuplicateTextures() const;
+    // Opt-in: keep only the first texture of each duplicate group, shrinking the
+    // saved file. Models referring to a removed name must be pointed at the kept
+    // one (use findDuplicateTextures first). Returns the number of textures removed.
+    size_t removeDuplicateTextures();
+    
+    // Arena loading, off by default
+    // When enabled, load places every palette and mip level in one BufferArena
+    // sized from the file, so loading makes a bounded number of allocations and
+    // the payloads are freed together. Duplicate payloads are shared before they
+    // are placed, so each distinct payload takes arena space once. Buffers that are later resized or written
+    // while shared move to the heap; the arena lives until no buffer uses it.
+    void setArenaEnabled(bool enabled) { arenaEnabled = enabled; }
+    bool isArenaEnabled() const { return arenaEnabled; }
+    // Arena of the last load, or nullptr
+    const BufferArena* getArena() const { return arena.get(); }
+    
     // Version info
     GameVersion getGameVersion() const { return gameVersion; }
     uint32_t getVersion() const { return version; }
@@ -48,11 +97,20 @@ public:
     bool save(const std::string& filepath) const;
     bool save(std::ostream& stream) const;
     
+    // Size in bytes save would write, computed from the texture headers
+    size_t getSerializedSize() const;
+    // Size save would write after converting every texture to target, without
+    // encoding anything. Exact for the layout writeD3D produces. Returns 0 for
+    // targets that cannot be written (non-D3D platforms, unknown raster formats).
+    size_t estimateSerializedSize(const ConversionTarget& target) const;
+    
 private:
     std::vector<Texture> textures;
     std::unordered_map<std::string, size_t> textureMap; // name -> index
     uint32_t version;
     GameVersion gameVersion;
+    bool arenaEnabled = false;
+    std::shared_ptr<BufferArena> arena;
     
     // Helper functions
     bool readFromStream(std::istream& stream);
@@ -8,6 +8,131 @@
 
 namespace LibTXD {
 
+namespace {
+
+// Places shared_ptr control blocks in a BufferArena, falling back to the heap
+// when it is full. The copy kept in each control block holds the arena alive.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    
+    std::shared_ptr<BufferArena> arena;
+    
+    explicit ArenaAllocator(std::shared_ptr<BufferArena> a) : arena(std::move(a)) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+    
+    T* allocate(size_t count) {
+        void* pointer = arena->allocate(count * sizeof(T), alignof(T));
+        return static_cast<T*>(pointer ? pointer : ::operator new(count * sizeof(T)));
+    }
+    void deallocate(T* pointer, size_t) {
+        if (!arena->contains(pointer)) {
+            ::operator delete(pointer);
+        }
+    }
+    
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+} // namespace
+
+BufferArena::BufferArena(size_t capacity)
+    : slab(new uint8_t[capacity])
+    , capacity(capacity) {
+}
+
+void* BufferArena::allocate(size_t size, size_t alignment) {
+    const uintptr_t base = reinterpret_cast<uintptr_t>(slab.get());
+    const size_t start = ((base + used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+    if (start > capacity || size > capacity - start) {
+        return nullptr;
+    }
+    used = start + size;
+    return slab.get() + start;
+}
+
+bool BufferArena::contains(const void* pointer) const {
+    const uint8_t* bytes = static_cast<const uint8_t*>(pointer);
+    return bytes >= slab.get() && bytes < slab.get() + capacity;
+}
+
+SharedBuffer::SharedBuffer(const std::shared_ptr<BufferArena>& arena, size_t size) {
+    void* slice = arena && size > 0 ? arena->allocate(size, 16) : nullptr;
+    if (slice) {
+        std::memset(slice, 0, size);
+        storage = std::allocate_shared<Storage>(ArenaAllocator<Storage>(arena), static_cast<uint8_t*>(slice), size);
+    } else {
+        storage = std::make_shared<Storage>(std::vector<uint8_t>(size));
+    }
+}
+
+uint64_t SharedBuffer::hash() const {
+    if (!storage) {
+        return hashData(nullptr, 0);
+    }
+    // Racing threads compute the same value, so a plain store is enough
+    if (!storage->hashValid.load(std::memory_order_acquire)) {
+        storage->hashValue.store(hashData(storage->begin(), storage->size()), std::memory_order_relaxed);
+        storage->hashValid.store(true, std::memory_order_release);
+    }
+    return storage->hashValue.load(std::memory_order_relaxed);
+}
+
+uint8_t* SharedBuffer::ownData() {
+    if (!storage) {
+        storage = std::make_shared<Storage>(std::vector<uint8_t>());
+    } else if (storage.use_count() > 1) {
+        const Storage& shared = *storage;
+        storage = std::make_shared<Storage>(std::vector<uint8_t>(shared.begin(), shared.begin() + shared.size()));
+    } else {
+        storage->hashValid.store(false, std::memory_order_relaxed);
+    }
+    return storage->begin();
+}
+
+std::vector<uint8_t>& SharedBuffer::ownVector() {
+    if (storage && storage->slice) {
+        storage = std::make_shared<Storage>(std::vector<uint8_t>(storage->slice, storage->slice + storage->sliceSize));
+    } else {
+        ownData();
+    }
+    return storage->bytes;
+}
+
+PayloadPool::PayloadPool(std::shared_ptr<BufferArena> arena)
+    : arena(std::move(arena)) {
+}
+
+SharedBuffer PayloadPool::read(std::istream& stream, size_t size) {
+    scratch.resize(size);
+    stream.read(reinterpret_cast<char*>(scratch.data()), static_cast<std::streamsize>(size));
+    // A short read leaves zeros, as reading straight into a new buffer would
+    const size_t got = static_cast<size_t>(std::max<std::streamsize>(stream.gcount(), 0));
+    std::fill(scratch.begin() + std::min(got, size), scratch.end(), 0);
+    
+    // Collisions are resolved by comparing bytes
+    const uint64_t hash = hashData(scratch.data(), size);
+    auto range = buffers.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const SharedBuffer& existing = it->second;
+        if (existing.size() == size && std::equal(scratch.begin(), scratch.end(), existing.begin())) {
+            sharedBytes += size;
+            return existing;
+        }
+    }
+    
+    SharedBuffer buffer(arena, size);
+    if (size > 0) {
+        std::memcpy(buffer.mutableData(), scratch.data(), size);
+    }
+    buffers.emplace(hash, buffer);
+    return buffer;
+}
+
 Texture::Texture()
     : platform(Platform::D3D8)
     , filterFlags(0)
@@ -71,12 +196,31 @@ MipmapLevel& Texture::getMipmap(size_t index) {
     return mipmaps[index];
 }
 
+uint64_t Texture::getMipmapHash(size_t index) const {
+    return getMipmap(index).data.hash();
+}
+
+uint64_t Texture::getContentHash() const {
+    const uint32_t fields[] = {
+        static_cast<uint32_t>(platform), filterFlags, static_cast<uint32_t>(rasterFormat), depth,
+        hasAlphaChannel ? 1u : 0u, static_cast<uint32_t>(compression), paletteSize,
+        static_cast<uint32_t>(mipmaps.size())
+    };
+    uint64_t hash = hashData(fields, sizeof(fields));
+    hash = hashData(palette.data(), palette.size(), hash);
+    for (const auto& mipmap : mipmaps) {
+        const uint64_t level[] = {mipmap.width, mipmap.height, mipmap.data.hash()};
+        hash = hashData(level, sizeof(level), hash);
+    }
+    return hash;
+}
+
 void Texture::addMipmap(MipmapLevel mipmap) {
     mipmaps.push_back(std::move(mipmap));
 }
 
-void Texture::setPalette(const std::vector<uint8_t>& pal, uint32_t size) {
-    palette = pal;
+void Texture::setPalette(SharedBuffer pal, uint32_t size) {
+    palette = std::move(pal);
     paletteSize = size;
 }
 
@@ -88,7 +232,41 @@ void Texture::clear() {
     swizzleHeight.clear();
 }
 
-bool Texture::readD3D(std::istream& stream) {
+uint32_t Texture::getFullMipmapCount(uint32_t width, uint32_t height) {
+    uint32_t size = std::max(width, height);
+    uint32_t count = 1;
+    while (size > 1) {
+        size /= 2;
+        count++;
+    }
+    return count;
+}
+
+void Texture::getMipmapDimensions(
+    uint32_t baseWidth,
+    uint32_t baseHeight,
+    uint32_t level,
+    Compression compression,
+    uint32_t& width,
+    uint32_t& height) {
+    
+    if (level == 0) {
+        width = baseWidth;
+        height = baseHeight;
+        return;
+    }
+    
+    width = level < 32 ? std::max(1u, baseWidth >> level) : 1u;
+    height = level < 32 ? std::max(1u, baseHeight >> level) : 1u;
+    
+    // DXT compression works on 4x4 blocks
+    if (compression != Compression::NONE) {
+        width = std::max(width, 4u);
+        height = std::max(height, 4u);
+    }
+}
+
+bool Texture::readD3D(std::istream& stream, PayloadPool* pool) {
     ChunkHeader header;
     if (!header.read(stream)) {
         return false;
@@ -102,7 +280,7 @@ bool Texture::readD3D(std::istream& stream) {
     size_t sectionEnd = sectionStart + header.length;
     
     // Read struct section
-    if (!readD3DStruct(stream, header)) {
+    if (!readD3DStruct(stream, header, pool)) {
         return false;
     }
     
@@ -112,7 +290,8 @@ bool Texture::readD3D(std::istream& stream) {
     return true;
 }
 
-bool Texture::readD3DStruct(std::istream& stream, ChunkHeader& parentHeader) {
+bool Texture::readD3DStruct(std::istream& stream, ChunkHeader& parentHeader,
+                            PayloadPool* pool) {
     ChunkHeader structHeader;
     if (!structHeader.read(stream)) {
         return false;
@@ -197,6 +376,8 @@ bool Texture::readD3DStruct(std::istream& stream, ChunkHeader& parentHeader) {
                     compression = Compression::DXT1;
                 } else if (fourcc[3] == '3') {
                     compression = Compression::DXT3;
+                } else if (fourcc[3] == '5') {
+                    compression = Compression::DXT5;
                 }
             }
         } else {
@@ -207,6 +388,8 @@ bool Texture::readD3DStruct(std::istream& stream, ChunkHeader& parentHeader) {
             compression = Compression::DXT1;
         } else if (compressionOrAlpha == 3) {
             compression = Compression::DXT3;
+        } else if (compressionOrAlpha == 5) {
+            compression = Compression::DXT5;
         }
     }
     
@@ -219,26 +402,21 @@ bool Texture::readD3DStruct(std::istream& stream, ChunkHeader& parentHeader) {
     }
     
     if (paletteSize > 0) {
-        palette.resize(paletteSize * 4);
-        stream.read(reinterpret_cast<char*>(palette.data()), paletteSize * 4);
+        if (pool) {
+            palette = pool->read(stream, paletteSize * 4);
+        } else {
+            palette.resize(paletteSize * 4);
+            stream.read(reinterpret_cast<char*>(palette.mutableData()), paletteSize * 4);
+        }
     }
     
     // Read mipmaps
     mipmaps.clear();
-    uint32_t currentWidth = width;
-    uint32_t currentHeight = height;
+    mipmaps.reserve(mipmapCount);
     
     for (uint32_t i = 0; i < mipmapCount; i++) {
-        if (i > 0) {
-            currentWidth = std::max(1u, currentWidth / 2);
-            currentHeight = std::max(1u, currentHeight / 2);
-            
-            // DXT compression works on 4x4 blocks
-            if (compression != Compression::NONE) {
-                if (currentWidth < 4 && currentWidth != 0) currentWidth = 4;
-                if (currentHeight < 4 && currentHeight != 0) currentHeight = 4;
-            }
-        }
+        uint32_t currentWidth, currentHeight;
+        getMipmapDimensions(width, height, i, compression, currentWidth, currentHeight);
         
         // Read mipmap size
         uint32_t mipSize;
@@ -255,8 +433,12 @@ bool Texture::readD3DStruct(std::istream& stream, ChunkHeader& parentHeader) {
         mipmap.dataSize = mipSize;
         
         if (mipSize > 0) {
-            mipmap.data.resize(mipSize);
-            stream.read(reinterpret_cast<char*>(mipmap.data.data()), mipSize);
+            if (pool) {
+                mipmap.data = pool->read(stream, mipSize);
+            } else {
+                mipmap.data.resize(mipSize);
+                stream.read(reinterpret_cast<char*>(mipmap.data.mutableData()), mipSize);
+            }
         }
         
         mipmaps.push_back(std::move(mipmap));
@@ -308,6 +490,24 @@ uint32_t Texture::writeD3D(std::ostream& stream, uint32_t version) const {
     return static_cast<uint32_t>(sectionEnd - sectionStart);
 }
 
+uint32_t Texture::getD3DSize() const {
+    // Mirrors what writeD3DStruct writes for palettes and levels
+    uint32_t paletteBytes = (paletteSize > 0 && !palette.empty()) ? paletteSize * 4 : 0;
+    size_t mipmapBytes = 0;
+    for (const auto& mipmap : mipmaps) {
+        if (mipmap.dataSize > 0 && !mipmap.data.empty()) {
+            mipmapBytes += mipmap.dataSize;
+        }
+    }
+    return getD3DSize(paletteBytes, static_cast<uint32_t>(mipmaps.size()), mipmapBytes);
+}
+
+uint32_t Texture::getD3DSize(uint32_t paletteBytes, uint32_t mipmapCount, size_t mipmapBytes) {
+    // TEXTURENATIVE header, STRUCT header, fixed struct fields, EXTENSION header
+    const uint32_t fixedSize = 12 + 12 + 88 + 12;
+    return fixedSize + paletteBytes + mipmapCount * 4 + static_cast<uint32_t>(mipmapBytes);
+}
+
 uint32_t Texture::writeD3DStruct(std::ostream& stream, uint32_t version) const {
     size_t structStart = stream.tellp();
     
@@ -349,10 +549,30 @@ uint32_t Texture::writeD3DStruct(std::ostream& stream, uint32_t version) const {
                 fourcc[0] = 'D'; fourcc[1] = 'X'; fourcc[2] = 'T'; fourcc[3] = '1';
             } else if (compression == Compression::DXT3) {
                 fourcc[0] = 'D'; fourcc[1] = 'X'; fourcc[2] = 'T'; fourcc[3] = '3';
+            } else if (compression == Compression::DXT5) {
+                fourcc[0] = 'D'; fourcc[1] = 'X'; fourcc[2] = 'T'; fourcc[3] = '5';
             }
             stream.write(fourcc, 4);
         } else {
-            uint32_t value = hasAlphaChannel ? 0x15 : 0x16;
+            // D3DFORMAT of the raster
+            uint32_t value = hasAlphaChannel ? 0x15 : 0x16;  // A8R8G8B8 / X8R8G8B8
+            switch (static_cast<uint32_t>(rasterFormat) & static_cast<uint32_t>(RasterFormat::MASK)) {
+                case static_cast<uint32_t>(RasterFormat::R5G6B5):
+                    value = 0x17;  // D3DFMT_R5G6B5
+                    break;
+                case static_cast<uint32_t>(RasterFormat::A1R5G5B5):
+                    value = 0x19;  // D3DFMT_A1R5G5B5
+                    break;
+                case static_cast<uint32_t>(RasterFormat::R4G4B4A4):
+                    value = 0x1A;  // D3DFMT_A4R4G4B4
+                    break;
+                case static_cast<uint32_t>(RasterFormat::LUM8):
+                    value = 0x32;  // D3DFMT_L8
+                    break;
+            }
+            if (paletteSize > 0) {
+                value = 0x29;  // D3DFMT_P8, PAL4 indices are widened to bytes too
+            }
             uint32_t valueLE = toLittleEndian32(value);
             stream.write(reinterpret_cast<const char*>(&valueLE), 4);
         }
@@ -6,16 +6,145 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <algorithm>
 #include <iosfwd>
 
 namespace LibTXD {
 
+// Monotonic slab that SharedBuffer payloads can be carved from
+// Allocation only moves a cursor forward and nothing is returned until the
+// arena itself goes, so a whole dictionary's buffers are freed in one piece.
+// Buffers keep the arena alive. Not thread-safe; fill it from one thread.
+class BufferArena {
+public:
+    explicit BufferArena(size_t capacity);
+    
+    // Non-copyable
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+    
+    // Next size bytes at the given alignment (a power of two), or nullptr when full
+    void* allocate(size_t size, size_t alignment);
+    bool contains(const void* pointer) const;
+    
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return used; }
+    
+private:
+    std::unique_ptr<uint8_t[]> slab;
+    size_t capacity;
+    size_t used = 0;
+};
+
+// Byte buffer whose copies share storage until one of them is modified
+// Provides the parts of std::vector<uint8_t> that mip data is used through.
+// data() and operator[] are read-only. Writes go through mutableData() or
+// resize(), which first give the buffer its own copy when the storage is
+// shared, so sharing is never observable.
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+    SharedBuffer(std::vector<uint8_t> bytes)
+        : storage(std::make_shared<Storage>(std::move(bytes))) {}
+    // size zeroed bytes placed in arena, or on the heap when arena is null or
+    // full. mutableData() writes in place until the buffer is copied; resize moves
+    // the bytes out of the arena.
+    SharedBuffer(const std::shared_ptr<BufferArena>& arena, size_t size);
+    
+    SharedBuffer& operator=(std::vector<uint8_t> bytes) {
+        storage = std::make_shared<Storage>(std::move(bytes));
+        return *this;
+    }
+    
+    size_t size() const { return storage ? storage->size() : 0; }
+    bool empty() const { return size() == 0; }
+    
+    const uint8_t* data() const { return storage ? storage->begin() : nullptr; }
+    const uint8_t& operator[](size_t index) const { return storage->begin()[index]; }
+    // Writable bytes; copies the storage first if another buffer shares it
+    uint8_t* mutableData() { return ownData(); }
+    const uint8_t* begin() const { return data(); }
+    const uint8_t* end() const { return data() + size(); }
+    
+    void resize(size_t size, uint8_t value = 0) { ownVector().resize(size, value); }
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        storage = std::make_shared<Storage>(std::vector<uint8_t>(first, last));
+    }
+    void clear() { storage.reset(); }
+    
+    // hashData of the contents, computed on first use and kept until the
+    // next mutableData() or resize(). Writes through a pointer obtained before
+    // the call are not seen, so finish writing before hashing.
+    uint64_t hash() const;
+    
+    // Whether both buffers use the same storage
+    bool sharesStorageWith(const SharedBuffer& other) const {
+        return storage && storage == other.storage;
+    }
+    // Whether the bytes live in an arena rather than on the heap
+    bool isArenaBacked() const { return storage && storage->slice; }
+    
+    bool operator==(const SharedBuffer& other) const {
+        return sharesStorageWith(other) ||
+               (size() == other.size() && std::equal(begin(), end(), other.begin()));
+    }
+    bool operator!=(const SharedBuffer& other) const { return !(*this == other); }
+    
+private:
+    struct Storage {
+        std::vector<uint8_t> bytes;  // Heap bytes, unused when slice is set
+        uint8_t* slice = nullptr;    // Bytes in a BufferArena
+        size_t sliceSize = 0;
+        mutable std::atomic<bool> hashValid{false};
+        mutable std::atomic<uint64_t> hashValue{0};
+        
+        explicit Storage(std::vector<uint8_t> b) : bytes(std::move(b)) {}
+        Storage(uint8_t* s, size_t size) : slice(s), sliceSize(size) {}
+        
+        uint8_t* begin() { return slice ? slice : bytes.data(); }
+        const uint8_t* begin() const { return slice ? slice : bytes.data(); }
+        size_t size() const { return slice ? sliceSize : bytes.size(); }
+    };
+    
+    // Unshares the storage and drops its cached hash
+    uint8_t* ownData();
+    // As ownData, also moving arena bytes to the heap so they can be resized
+    std::vector<uint8_t>& ownVector();
+    
+    std::shared_ptr<Storage> storage;
+};
+
+// Places payloads read during one load in an arena, sharing identical ones
+// Each payload is hashed before it is placed, so a duplicate shares the
+// earlier buffer and takes no arena space. The pool holds a reference to
+// every buffer it hands out, so destroy it once loading is done.
+class PayloadPool {
+public:
+    explicit PayloadPool(std::shared_ptr<BufferArena> arena);
+    
+    // Reads size bytes from the stream into a new or existing buffer
+    SharedBuffer read(std::istream& stream, size_t size);
+    
+    // Bytes that were shared instead of placed
+    size_t getSharedBytes() const { return sharedBytes; }
+    
+private:
+    std::shared_ptr<BufferArena> arena;
+    std::unordered_multimap<uint64_t, SharedBuffer> buffers;
+    std::vector<uint8_t> scratch;
+    size_t sharedBytes = 0;
+};
+
 // Mipmap level data
+// Copying a level is cheap: the copy shares data until either side modifies it.
 struct MipmapLevel {
     uint32_t width;
     uint32_t height;
     uint32_t dataSize;
-    std::vector<uint8_t> data;
+    SharedBuffer data;
     
     MipmapLevel() : width(0), height(0), dataSize(0) {}
 };
@@ -46,7 +175,13 @@ public:
     const MipmapLevel& getMipmap(size_t index) const;
     MipmapLevel& getMipmap(size_t index);
     
-    const std::vector<uint8_t>& getPalette() const { return palette; }
+    // Cached hashData of one level's bytes; see SharedBuffer::hash
+    uint64_t getMipmapHash(size_t index) const;
+    // Hash of the format, palette and every mip level, leaving out the name and
+    // mask name. Cheap after the first call since the level hashes are cached.
+    uint64_t getContentHash() const;
+    
+    const SharedBuffer& getPalette() const { return palette; }
     uint32_t getPaletteSize() const { return paletteSize; }
     
     // Setters
@@ -60,19 +195,40 @@ public:
     void setCompression(Compression comp) { compression = comp; }
     
     void addMipmap(MipmapLevel mipmap);
-    void setPalette(const std::vector<uint8_t>& pal, uint32_t size);
+    void clearMipmaps() { mipmaps.clear(); }
+    void setPalette(SharedBuffer pal, uint32_t size);
     
     // Reading
-    bool readD3D(std::istream& stream);
+    // Palette and mip data are read through pool when one is given
+    bool readD3D(std::istream& stream, PayloadPool* pool = nullptr);
     bool readXbox(std::istream& stream);
     bool readPS2(std::istream& stream);
     
     // Writing
     uint32_t writeD3D(std::ostream& stream, uint32_t version = 0x1803FFFF) const;
     
+    // Bytes writeD3D writes for this texture, without writing
+    uint32_t getD3DSize() const;
+    // Bytes of a D3D texture native with the given palette and mip data sizes
+    static uint32_t getD3DSize(uint32_t paletteBytes, uint32_t mipmapCount, size_t mipmapBytes);
+    
     // Utility
     void clear();
     
+    // Number of levels in a full mip chain down to 1x1
+    static uint32_t getFullMipmapCount(uint32_t width, uint32_t height);
+    
+    // Dimensions of a mip level as stored in D3D textures (and as readD3D reports them):
+    // each level halves down to 1, but DXT levels never go below one 4x4 block
+    static void getMipmapDimensions(
+        uint32_t baseWidth,
+        uint32_t baseHeight,
+        uint32_t level,
+        Compression compression,
+        uint32_t& width,
+        uint32_t& height
+    );
+    
 private:
     Platform platform;
     std::string name;
@@ -84,7 +240,7 @@ private:
     Compression compression;
     
     std::vector<MipmapLevel> mipmaps;
-    std::vector<uint8_t> palette;
+    SharedBuffer palette;
     uint32_t paletteSize;
     
     // PS2 specific
@@ -92,7 +248,7 @@ private:
     std::vector<uint32_t> swizzleHeight;
     
     // Helper functions
-    bool readD3DStruct(std::istream& stream, ChunkHeader& header);
+    bool readD3DStruct(std::istream& stream, ChunkHeader& header, PayloadPool* pool);
     bool readXboxStruct(std::istream& stream, ChunkHeader& header);
     bool readPS2Struct(std::istream& stream, ChunkHeader& header);
     uint32_t writeD3DStruct(std::ostream& stream, uint32_t version) const;
@@ -53,7 +53,8 @@ enum class RasterFormat : uint32_t {
 enum class Compression : uint8_t {
     NONE = 0,
     DXT1 = 1,
-    DXT3 = 3
+    DXT3 = 3,
+    DXT5 = 5
 };
 
 // Game versions (for version detection)
@@ -112,6 +113,10 @@ inline uint16_t fromLittleEndian16(uint16_t value) {
 #endif
 }
 
+// 64-bit non-cryptographic hash (XXH64) of a byte range, used for content
+// keyed caches. Stable across runs and platforms.
+uint64_t hashData(const void* data, size_t size, uint64_t seed = 0);
+
 // Chunk header structure
 struct ChunkHeader {
     ChunkType type;
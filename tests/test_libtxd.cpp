@@ -9,11 +9,15 @@
 #include <sstream>
 #include <filesystem>
 #include <cstring>
+#include <limits>
+#include <cmath>
 
 #include "libtxd/txd_types.h"
 #include "libtxd/txd_texture.h"
 #include "libtxd/txd_dictionary.h"
 #include "libtxd/txd_converter.h"
+#include "libtxd/txd_cache.h"
+#include <squish.h>
 
 namespace fs = std::filesystem;
 
@@ -127,6 +131,20 @@ TEST_F(TxdTypesTest, PlatformEnum_HasCorrectValues) {
     EXPECT_EQ(static_cast<uint32_t>(LibTXD::Platform::XBOX), 5);
 }
 
+TEST_F(TxdTypesTest, HashData_MatchesXXH64) {
+    EXPECT_EQ(LibTXD::hashData("", 0), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(LibTXD::hashData("abc", 3), 0x44BC2CF5AD770999ULL);
+    
+    std::vector<uint8_t> data(100);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+    uint64_t hash = LibTXD::hashData(data.data(), data.size());
+    EXPECT_NE(hash, LibTXD::hashData(data.data(), data.size(), 1));
+    data[99] ^= 1;
+    EXPECT_NE(hash, LibTXD::hashData(data.data(), data.size()));
+}
+
 // ============================================================================
 // Texture Tests
 // ============================================================================
@@ -251,6 +269,30 @@ TEST_F(TextureTest, Clear_ResetsTexture) {
     EXPECT_EQ(texture.getPaletteSize(), 0u);
 }
 
+TEST_F(TextureTest, GetMipmapDimensions_ClampsDXTToBlockSize) {
+    uint32_t width = 0, height = 0;
+    
+    LibTXD::Texture::getMipmapDimensions(16, 8, 0, LibTXD::Compression::DXT1, width, height);
+    EXPECT_EQ(width, 16u);
+    EXPECT_EQ(height, 8u);
+    
+    LibTXD::Texture::getMipmapDimensions(16, 8, 2, LibTXD::Compression::NONE, width, height);
+    EXPECT_EQ(width, 4u);
+    EXPECT_EQ(height, 2u);
+    
+    LibTXD::Texture::getMipmapDimensions(16, 8, 2, LibTXD::Compression::DXT1, width, height);
+    EXPECT_EQ(width, 4u);
+    EXPECT_EQ(height, 4u);
+    
+    LibTXD::Texture::getMipmapDimensions(16, 8, 4, LibTXD::Compression::NONE, width, height);
+    EXPECT_EQ(width, 1u);
+    EXPECT_EQ(height, 1u);
+    
+    EXPECT_EQ(LibTXD::Texture::getFullMipmapCount(16, 8), 5u);
+    EXPECT_EQ(LibTXD::Texture::getFullMipmapCount(1, 1), 1u);
+    EXPECT_EQ(LibTXD::Texture::getFullMipmapCount(256, 3), 9u);
+}
+
 TEST_F(TextureTest, MoveConstructor_TransfersData) {
     LibTXD::Texture texture1;
     texture1.setName("original");
@@ -271,6 +313,49 @@ TEST_F(TextureTest, MoveConstructor_TransfersData) {
     EXPECT_EQ(texture2.getMipmap(0).data[0], 0x42);
 }
 
+TEST_F(TextureTest, MipmapCopy_SharesDataUntilModified) {
+    LibTXD::MipmapLevel mip;
+    mip.width = 4;
+    mip.height = 4;
+    mip.data = std::vector<uint8_t>(64, 0x11);
+    mip.dataSize = 64;
+    
+    LibTXD::MipmapLevel copy = mip;
+    EXPECT_TRUE(copy.data.sharesStorageWith(mip.data));
+    
+    copy.data.mutableData()[0] = 0x22;
+    EXPECT_FALSE(copy.data.sharesStorageWith(mip.data));
+    EXPECT_EQ(mip.data[0], 0x11);
+    EXPECT_EQ(copy.data[0], 0x22);
+    EXPECT_EQ(copy.data[1], 0x11);
+    EXPECT_NE(copy.data, mip.data);
+}
+
+TEST_F(TextureTest, MipmapHash_CachedAndInvalidatedOnWrite) {
+    std::vector<uint8_t> bytes(256);
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = static_cast<uint8_t>(i * 7);
+    }
+    
+    LibTXD::Texture texture;
+    LibTXD::MipmapLevel mip;
+    mip.width = 8;
+    mip.height = 8;
+    mip.dataSize = 256;
+    mip.data = bytes;
+    texture.addMipmap(std::move(mip));
+    
+    uint64_t hash = texture.getMipmapHash(0);
+    EXPECT_EQ(hash, LibTXD::hashData(bytes.data(), bytes.size()));
+    EXPECT_EQ(texture.getMipmapHash(0), hash);
+    
+    LibTXD::MipmapLevel copy = texture.getMipmap(0);
+    texture.getMipmap(0).data.mutableData()[5] ^= 0xFF;
+    bytes[5] ^= 0xFF;
+    EXPECT_EQ(texture.getMipmapHash(0), LibTXD::hashData(bytes.data(), bytes.size()));
+    EXPECT_EQ(copy.data.hash(), hash);
+}
+
 // ============================================================================
 // Texture Dictionary Tests
 // ============================================================================
@@ -412,6 +497,260 @@ TEST_F(TextureDictionaryTest, SetVersion_UpdatesVersion) {
     EXPECT_EQ(dict.getVersion(), 0x1803FFFF);
 }
 
+namespace {
+
+LibTXD::Texture makeSolidTexture(const std::string& name, uint8_t value) {
+    LibTXD::Texture texture;
+    texture.setName(name);
+    texture.setPlatform(LibTXD::Platform::D3D9);
+    texture.setRasterFormat(LibTXD::RasterFormat::B8G8R8A8);
+    texture.setDepth(32);
+    texture.setHasAlpha(true);
+    for (uint32_t size = 8; size >= 4; size /= 2) {
+        LibTXD::MipmapLevel mip;
+        mip.width = size;
+        mip.height = size;
+        mip.dataSize = size * size * 4;
+        mip.data = std::vector<uint8_t>(mip.dataSize, value);
+        texture.addMipmap(std::move(mip));
+    }
+    return texture;
+}
+
+} // namespace
+
+TEST_F(TextureDictionaryTest, Load_SharesDuplicateMipData) {
+    LibTXD::TextureDictionary dict;
+    dict.addTexture(makeSolidTexture("a", 0x40));
+    dict.addTexture(makeSolidTexture("b", 0x40));
+    dict.addTexture(makeSolidTexture("c", 0x80));
+    
+    std::stringstream stream;
+    ASSERT_TRUE(dict.save(stream));
+    LibTXD::TextureDictionary loaded;
+    ASSERT_TRUE(loaded.load(stream));
+    ASSERT_EQ(loaded.getTextureCount(), 3u);
+    
+    const auto& a = loaded.findTexture("a")->getMipmap(0).data;
+    const auto& b = loaded.findTexture("b")->getMipmap(0).data;
+    const auto& c = loaded.findTexture("c")->getMipmap(0).data;
+    EXPECT_TRUE(a.sharesStorageWith(b));
+    EXPECT_FALSE(a.sharesStorageWith(c));
+    EXPECT_EQ(loaded.shareDuplicateData(), 0u);
+    
+    // Writing through one texture leaves the other untouched
+    loaded.findTexture("b")->getMipmap(0).data.mutableData()[0] = 0x00;
+    EXPECT_EQ(loaded.findTexture("a")->getMipmap(0).data[0], 0x40);
+}
+
+TEST_F(TextureDictionaryTest, Load_ArenaHoldsPayloads) {
+    LibTXD::TextureDictionary dict;
+    dict.addTexture(makeSolidTexture("a", 0x40));
+    dict.addTexture(makeSolidTexture("c", 0x80));
+    
+    LibTXD::Texture paletted;
+    paletted.setName("p");
+    paletted.setPlatform(LibTXD::Platform::D3D9);
+    paletted.setRasterFormat(static_cast<LibTXD::RasterFormat>(
+        static_cast<uint32_t>(LibTXD::RasterFormat::PAL8) | static_cast<uint32_t>(LibTXD::RasterFormat::B8G8R8A8)));
+    paletted.setDepth(8);
+    paletted.setPalette(std::vector<uint8_t>(256 * 4, 0x11), 256);
+    LibTXD::MipmapLevel mip;
+    mip.width = 4;
+    mip.height = 4;
+    mip.dataSize = 16;
+    mip.data = std::vector<uint8_t>(16, 3);
+    paletted.addMipmap(std::move(mip));
+    dict.addTexture(std::move(paletted));
+    
+    std::stringstream stream;
+    ASSERT_TRUE(dict.save(stream));
+    const std::string bytes = stream.str();
+    
+    LibTXD::TextureDictionary plain;
+    std::istringstream plainStream(bytes);
+    ASSERT_TRUE(plain.load(plainStream));
+    EXPECT_EQ(plain.getArena(), nullptr);
+    
+    LibTXD::TextureDictionary loaded;
+    loaded.setArenaEnabled(true);
+    std::istringstream arenaStream(bytes);
+    ASSERT_TRUE(loaded.load(arenaStream));
+    ASSERT_NE(loaded.getArena(), nullptr);
+    EXPECT_GT(loaded.getArena()->getUsed(), 0u);
+    EXPECT_LE(loaded.getArena()->getUsed(), loaded.getArena()->getCapacity());
+    EXPECT_EQ(loaded.getContentHash(), plain.getContentHash());
+    
+    for (size_t t = 0; t < loaded.getTextureCount(); t++) {
+        const auto* texture = loaded.getTexture(t);
+        for (size_t level = 0; level < texture->getMipmapCount(); level++) {
+            EXPECT_TRUE(texture->getMipmap(level).data.isArenaBacked()) << texture->getName() << " " << level;
+        }
+    }
+    EXPECT_TRUE(loaded.findTexture("p")->getPalette().isArenaBacked());
+    
+    // Unshared bytes are written in place; resizing moves them to the heap
+    auto& data = loaded.findTexture("c")->getMipmap(0).data;
+    data.mutableData()[0] = 0x00;
+    EXPECT_TRUE(data.isArenaBacked());
+    data.resize(data.size() + 4);
+    EXPECT_FALSE(data.isArenaBacked());
+    EXPECT_EQ(data[0], 0x00);
+    EXPECT_EQ(data[1], 0x80);
+    
+    // Textures outliving the dictionary keep the slab alive
+    LibTXD::Texture kept = std::move(*loaded.findTexture("a"));
+    loaded.clear();
+    EXPECT_EQ(loaded.getArena(), nullptr);
+    EXPECT_TRUE(kept.getMipmap(1).data.isArenaBacked());
+    EXPECT_EQ(kept.getMipmap(1).data[15], 0x40);
+}
+
+TEST_F(TextureDictionaryTest, Load_ArenaSharesDuplicatesBeforePlacing) {
+    auto loadWithArena = [](const LibTXD::TextureDictionary& source, LibTXD::TextureDictionary& loaded) {
+        std::stringstream stream;
+        ASSERT_TRUE(source.save(stream));
+        loaded.setArenaEnabled(true);
+        ASSERT_TRUE(loaded.load(stream));
+        ASSERT_NE(loaded.getArena(), nullptr);
+    };
+    
+    LibTXD::TextureDictionary single;
+    single.addTexture(makeSolidTexture("a", 0x40));
+    LibTXD::TextureDictionary duplicated;
+    duplicated.addTexture(makeSolidTexture("a", 0x40));
+    duplicated.addTexture(makeSolidTexture("b", 0x40));
+    
+    LibTXD::TextureDictionary loadedSingle, loadedDuplicated;
+    loadWithArena(single, loadedSingle);
+    loadWithArena(duplicated, loadedDuplicated);
+    
+    // The second copy shares the first buffer and takes no arena space
+    const auto& a = loadedDuplicated.findTexture("a")->getMipmap(0).data;
+    const auto& b = loadedDuplicated.findTexture("b")->getMipmap(0).data;
+    EXPECT_TRUE(a.sharesStorageWith(b));
+    EXPECT_TRUE(a.isArenaBacked());
+    EXPECT_EQ(loadedDuplicated.getArena()->getUsed(), loadedSingle.getArena()->getUsed());
+    EXPECT_EQ(loadedDuplicated.shareDuplicateData(), 0u);
+}
+
+TEST_F(TextureDictionaryTest, ContentHash_TracksTextureChanges) {
+    LibTXD::TextureDictionary dict;
+    dict.addTexture(makeSolidTexture("a", 0x40));
+    dict.addTexture(makeSolidTexture("b", 0x40));
+    
+    // Same data under different names: equal texture hashes, different dictionary hash
+    EXPECT_EQ(dict.getTexture(0)->getContentHash(), dict.getTexture(1)->getContentHash());
+    uint64_t before = dict.getContentHash();
+    dict.getTexture(1)->setName("c");
+    EXPECT_NE(dict.getContentHash(), before);
+    dict.getTexture(1)->setName("b");
+    EXPECT_EQ(dict.getContentHash(), before);
+    
+    dict.getTexture(1)->getMipmap(1).data.mutableData()[0] = 0x41;
+    EXPECT_NE(dict.getTexture(0)->getContentHash(), dict.getTexture(1)->getContentHash());
+    EXPECT_NE(dict.getContentHash(), before);
+}
+
+TEST_F(TextureDictionaryTest, SerializedSize_MatchesSave) {
+    LibTXD::TextureDictionary dict;
+    dict.addTexture(makeSolidTexture("a", 0x40));
+    LibTXD::Texture palettised = makeSolidTexture("pal", 0x01);
+    palettised.setPalette(std::vector<uint8_t>(256 * 4, 0x7F), 256);
+    dict.addTexture(std::move(palettised));
+    dict.addTexture(LibTXD::Texture());
+    
+    std::stringstream stream;
+    ASSERT_TRUE(dict.save(stream));
+    EXPECT_EQ(dict.getSerializedSize(), stream.str().size());
+}
+
+TEST_F(TextureDictionaryTest, EstimateSerializedSize_MatchesConvertedDictionary) {
+    const uint32_t sizes[][2] = {{64, 32}, {8, 8}, {13, 7}};
+    LibTXD::TextureDictionary source;
+    LibTXD::TextureDictionary converted;
+    for (const auto& size : sizes) {
+        const uint32_t width = size[0];
+        const uint32_t height = size[1];
+        std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4, 0x80);
+        
+        LibTXD::Texture texture;
+        texture.setName("tex" + std::to_string(width));
+        texture.setPlatform(LibTXD::Platform::D3D9);
+        texture.setRasterFormat(LibTXD::RasterFormat::B8G8R8A8);
+        LibTXD::MipmapLevel mip;
+        mip.width = width;
+        mip.height = height;
+        mip.dataSize = static_cast<uint32_t>(rgba.size());
+        mip.data = rgba;
+        texture.addMipmap(std::move(mip));
+        source.addTexture(std::move(texture));
+        
+        LibTXD::Texture dxt;
+        dxt.setName("tex" + std::to_string(width));
+        dxt.setPlatform(LibTXD::Platform::D3D9);
+        dxt.setRasterFormat(LibTXD::RasterFormat::B8G8R8);
+        dxt.setDepth(16);
+        dxt.setCompression(LibTXD::Compression::DXT1);
+        auto levels = LibTXD::TextureConverter::generateMipmaps(rgba.data(), width, height);
+        for (uint32_t level = 0; level < levels.size(); level++) {
+            size_t bytes = LibTXD::TextureConverter::getCompressedDataSize(
+                levels[level].width, levels[level].height, LibTXD::Compression::DXT1);
+            auto compressed = LibTXD::TextureConverter::compressToDXT(
+                levels[level].rgba.data(), levels[level].width, levels[level].height, LibTXD::Compression::DXT1);
+            ASSERT_NE(compressed, nullptr);
+            LibTXD::MipmapLevel dxtMip;
+            LibTXD::Texture::getMipmapDimensions(width, height, level, LibTXD::Compression::DXT1,
+                                                 dxtMip.width, dxtMip.height);
+            dxtMip.data.assign(compressed.get(), compressed.get() + bytes);
+            dxtMip.dataSize = static_cast<uint32_t>(bytes);
+            dxt.addMipmap(std::move(dxtMip));
+        }
+        converted.addTexture(std::move(dxt));
+    }
+    
+    std::stringstream stream;
+    ASSERT_TRUE(converted.save(stream));
+    
+    LibTXD::ConversionTarget target;
+    target.compression = LibTXD::Compression::DXT1;
+    target.mipmaps = LibTXD::MipmapPolicy::FullChain;
+    EXPECT_EQ(source.estimateSerializedSize(target), stream.str().size());
+    
+    // Keeping the single level of an uncompressed source reproduces its own size
+    target.compression = LibTXD::Compression::NONE;
+    target.mipmaps = LibTXD::MipmapPolicy::Keep;
+    EXPECT_EQ(source.estimateSerializedSize(target), source.getSerializedSize());
+    
+    target.platform = LibTXD::Platform::PS2;
+    EXPECT_EQ(source.estimateSerializedSize(target), 0u);
+}
+
+TEST_F(TextureDictionaryTest, RemoveDuplicateTextures_KeepsFirstOfEachGroup) {
+    LibTXD::TextureDictionary dict;
+    dict.addTexture(makeSolidTexture("wheel", 0x10));
+    dict.addTexture(makeSolidTexture("body", 0x20));
+    dict.addTexture(makeSolidTexture("wheel_rear", 0x10));
+    dict.addTexture(makeSolidTexture("body2", 0x20));
+    dict.addTexture(makeSolidTexture("wheel_spare", 0x10));
+    dict.addTexture(makeSolidTexture("glass", 0x30));
+    
+    auto groups = dict.findDuplicateTextures();
+    ASSERT_EQ(groups.size(), 2u);
+    EXPECT_EQ(groups[0].names, (std::vector<std::string>{"wheel", "wheel_rear", "wheel_spare"}));
+    EXPECT_EQ(groups[1].names, (std::vector<std::string>{"body", "body2"}));
+    EXPECT_EQ(groups[0].bytes, (8u * 8u + 4u * 4u) * 4u);
+    
+    EXPECT_EQ(dict.removeDuplicateTextures(), 3u);
+    ASSERT_EQ(dict.getTextureCount(), 3u);
+    EXPECT_EQ(dict.getTexture(0)->getName(), "wheel");
+    EXPECT_EQ(dict.getTexture(1)->getName(), "body");
+    EXPECT_EQ(dict.getTexture(2)->getName(), "glass");
+    EXPECT_EQ(dict.findTexture("wheel_rear"), nullptr);
+    EXPECT_NE(dict.findTexture("glass"), nullptr);
+    EXPECT_TRUE(dict.findDuplicateTextures().empty());
+}
+
 // ============================================================================
 // Dictionary File I/O Tests (using example files)
 // ============================================================================
@@ -653,11 +992,20 @@ TEST_F(TextureConverterTest, GetCompressedDataSize_None_ReturnsZero) {
     EXPECT_EQ(LibTXD::TextureConverter::getCompressedDataSize(64, 64, LibTXD::Compression::NONE), 0u);
 }
 
+TEST_F(TextureConverterTest, GetDXTRasterFormat_FollowsRenderWareConvention) {
+    using LibTXD::Compression;
+    using LibTXD::RasterFormat;
+    EXPECT_EQ(LibTXD::TextureConverter::getDXTRasterFormat(Compression::DXT1, false), RasterFormat::R5G6B5);
+    EXPECT_EQ(LibTXD::TextureConverter::getDXTRasterFormat(Compression::DXT1, true), RasterFormat::A1R5G5B5);
+    EXPECT_EQ(LibTXD::TextureConverter::getDXTRasterFormat(Compression::DXT3, true), RasterFormat::R4G4B4A4);
+    EXPECT_EQ(LibTXD::TextureConverter::getDXTRasterFormat(Compression::DXT5, true), RasterFormat::B8G8R8A8);
+}
+
 TEST_F(TextureConverterTest, CompressToDXT1_ProducesValidOutput) {
     auto rgba = createTestRGBA(8, 8, 255, 0, 0, 255);  // Red image
     
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        rgba.data(), 8, 8, LibTXD::Compression::DXT1, 1.0f);
+        rgba.data(), 8, 8, LibTXD::Compression::DXT1);
     
     ASSERT_NE(compressed, nullptr);
     
@@ -669,14 +1017,14 @@ TEST_F(TextureConverterTest, CompressToDXT3_ProducesValidOutput) {
     auto rgba = createTestRGBA(8, 8, 0, 255, 0, 128);  // Semi-transparent green
     
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        rgba.data(), 8, 8, LibTXD::Compression::DXT3, 1.0f);
+        rgba.data(), 8, 8, LibTXD::Compression::DXT3);
     
     ASSERT_NE(compressed, nullptr);
 }
 
 TEST_F(TextureConverterTest, CompressToDXT_NullInput_ReturnsNull) {
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        nullptr, 8, 8, LibTXD::Compression::DXT1, 1.0f);
+        nullptr, 8, 8, LibTXD::Compression::DXT1);
     
     EXPECT_EQ(compressed, nullptr);
 }
@@ -685,7 +1033,7 @@ TEST_F(TextureConverterTest, CompressToDXT_ZeroDimension_ReturnsNull) {
     auto rgba = createTestRGBA(8, 8, 255, 255, 255, 255);
     
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        rgba.data(), 0, 8, LibTXD::Compression::DXT1, 1.0f);
+        rgba.data(), 0, 8, LibTXD::Compression::DXT1);
     
     EXPECT_EQ(compressed, nullptr);
 }
@@ -695,7 +1043,7 @@ TEST_F(TextureConverterTest, DecompressDXT1_ProducesValidOutput) {
     auto rgba = createGradientRGBA(8, 8);
     
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        rgba.data(), 8, 8, LibTXD::Compression::DXT1, 1.0f);
+        rgba.data(), 8, 8, LibTXD::Compression::DXT1);
     ASSERT_NE(compressed, nullptr);
     
     auto decompressed = LibTXD::TextureConverter::decompressDXT(
@@ -708,7 +1056,7 @@ TEST_F(TextureConverterTest, DecompressDXT3_ProducesValidOutput) {
     auto rgba = createGradientRGBA(8, 8);
     
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        rgba.data(), 8, 8, LibTXD::Compression::DXT3, 1.0f);
+        rgba.data(), 8, 8, LibTXD::Compression::DXT3);
     ASSERT_NE(compressed, nullptr);
     
     auto decompressed = LibTXD::TextureConverter::decompressDXT(
@@ -722,7 +1070,7 @@ TEST_F(TextureConverterTest, DXT1_CompressDecompress_Roundtrip) {
     auto original = createTestRGBA(16, 16, 128, 64, 192, 255);
     
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        original.data(), 16, 16, LibTXD::Compression::DXT1, 1.0f);
+        original.data(), 16, 16, LibTXD::Compression::DXT1);
     ASSERT_NE(compressed, nullptr);
     
     auto decompressed = LibTXD::TextureConverter::decompressDXT(
@@ -741,6 +1089,633 @@ TEST_F(TextureConverterTest, DXT1_CompressDecompress_Roundtrip) {
     EXPECT_LT(maxDiff, 20) << "DXT roundtrip error too high";
 }
 
+TEST_F(TextureConverterTest, CompressToDXT_Realtime_SolidColourRoundtrip) {
+    auto original = createTestRGBA(16, 16, 128, 64, 192, 255);
+    
+    for (auto compression : {LibTXD::Compression::DXT1, LibTXD::Compression::DXT3}) {
+        auto compressed = LibTXD::TextureConverter::compressToDXT(
+            original.data(), 16, 16, compression, LibTXD::CompressionSpeed::Realtime);
+        ASSERT_NE(compressed, nullptr);
+        
+        auto decompressed = LibTXD::TextureConverter::decompressDXT(
+            compressed.get(), 16, 16, compression);
+        ASSERT_NE(decompressed, nullptr);
+        
+        int maxDiff = 0;
+        for (size_t i = 0; i < 16 * 16 * 4; i++) {
+            int diff = std::abs(static_cast<int>(original[i]) - static_cast<int>(decompressed[i]));
+            maxDiff = std::max(maxDiff, diff);
+        }
+        EXPECT_LT(maxDiff, 10) << "Realtime roundtrip error too high";
+    }
+}
+
+TEST_F(TextureConverterTest, CompressToDXT_Realtime_GradientCloseToRangeFit) {
+    auto original = createGradientRGBA(64, 64);
+    
+    auto errorFor = [&](LibTXD::CompressionSpeed speed) {
+        auto compressed = LibTXD::TextureConverter::compressToDXT(
+            original.data(), 64, 64, LibTXD::Compression::DXT1, speed);
+        auto decompressed = LibTXD::TextureConverter::decompressDXT(
+            compressed.get(), 64, 64, LibTXD::Compression::DXT1);
+        double sum = 0.0;
+        for (size_t i = 0; i < original.size(); i++) {
+            if (i % 4 == 3) continue;
+            double diff = static_cast<double>(original[i]) - decompressed[i];
+            sum += diff * diff;
+        }
+        return sum / (64.0 * 64.0 * 3.0);
+    };
+    
+    double realtimeMSE = errorFor(LibTXD::CompressionSpeed::Realtime);
+    double rangeFitMSE = errorFor(LibTXD::CompressionSpeed::RangeFit);
+    EXPECT_LT(realtimeMSE, 16.0);
+    EXPECT_LT(realtimeMSE, rangeFitMSE * 2.0 + 1.0);
+}
+
+TEST_F(TextureConverterTest, CompressToDXT_Realtime_DXT1KeepsPunchThroughAlpha) {
+    auto original = createTestRGBA(6, 6, 255, 255, 255, 255);
+    for (size_t i = 0; i < 6 * 6; i += 2) {
+        original[i * 4 + 3] = 0;
+    }
+    
+    auto compressed = LibTXD::TextureConverter::compressToDXT(
+        original.data(), 6, 6, LibTXD::Compression::DXT1, LibTXD::CompressionSpeed::Realtime);
+    ASSERT_NE(compressed, nullptr);
+    
+    auto decompressed = LibTXD::TextureConverter::decompressDXT(
+        compressed.get(), 6, 6, LibTXD::Compression::DXT1);
+    ASSERT_NE(decompressed, nullptr);
+    
+    for (size_t i = 0; i < 6 * 6; i++) {
+        EXPECT_EQ(decompressed[i * 4 + 3], original[i * 4 + 3]) << "Pixel " << i;
+    }
+}
+
+TEST_F(TextureConverterTest, CompressToDXT_AllProfilesProduceDecodableOutput) {
+    auto original = createGradientRGBA(16, 16);
+    
+    const LibTXD::CompressionProfile profiles[] = {
+        LibTXD::CompressionProfile::realtime(),
+        LibTXD::CompressionProfile::rangeFit(),
+        LibTXD::CompressionProfile::clusterFit(),
+        LibTXD::CompressionProfile::iterativeClusterFit(),
+        LibTXD::CompressionProfile::uniform(),
+        LibTXD::CompressionProfile(LibTXD::CompressionSpeed::ClusterFit, true, true),
+    };
+    
+    for (const auto& profile : profiles) {
+        auto compressed = LibTXD::TextureConverter::compressToDXT(
+            original.data(), 16, 16, LibTXD::Compression::DXT3, profile);
+        ASSERT_NE(compressed, nullptr);
+        
+        auto decompressed = LibTXD::TextureConverter::decompressDXT(
+            compressed.get(), 16, 16, LibTXD::Compression::DXT3);
+        ASSERT_NE(decompressed, nullptr);
+        EXPECT_EQ(decompressed[3], 255);
+    }
+}
+
+TEST_F(TextureConverterTest, BenchmarkProfiles_ReportsEveryNamedProfile) {
+    auto original = createGradientRGBA(32, 32);
+    
+    auto results = LibTXD::TextureConverter::benchmarkProfiles(
+        original.data(), 32, 32, LibTXD::Compression::DXT1);
+    
+    ASSERT_EQ(results.size(), 5u);
+    EXPECT_EQ(results[0].profile, LibTXD::CompressionProfile::realtime());
+    EXPECT_EQ(results[3].profile, LibTXD::CompressionProfile::iterativeClusterFit());
+    for (const auto& result : results) {
+        EXPECT_FALSE(result.name.empty());
+        EXPECT_GT(result.megapixelsPerSecond, 0.0);
+        EXPECT_GE(result.rmse, 0.0);
+        EXPECT_LT(result.rmse, 8.0) << result.name;
+    }
+    
+    // Iterative cluster fit never does worse than a single cluster fit pass
+    EXPECT_LE(results[3].rmse, results[2].rmse + 1e-9);
+}
+
+TEST_F(TextureConverterTest, CompressToDXT_IterativeClusterFitIsDistinct) {
+    // Noise gives every block enough colours for extra iterations to matter
+    std::vector<uint8_t> rgba(64 * 64 * 4);
+    uint32_t seed = 777;
+    for (auto& value : rgba) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<uint8_t>(seed >> 24);
+    }
+    
+    const size_t size = LibTXD::TextureConverter::getCompressedDataSize(64, 64, LibTXD::Compression::DXT1);
+    auto cluster = LibTXD::TextureConverter::compressToDXT(rgba.data(), 64, 64, LibTXD::Compression::DXT1,
+                                                           LibTXD::CompressionProfile::clusterFit());
+    auto iterative = LibTXD::TextureConverter::compressToDXT(rgba.data(), 64, 64, LibTXD::Compression::DXT1,
+                                                             LibTXD::CompressionProfile::iterativeClusterFit());
+    ASSERT_NE(cluster, nullptr);
+    ASSERT_NE(iterative, nullptr);
+    EXPECT_NE(std::memcmp(cluster.get(), iterative.get(), size), 0);
+    
+    // The default profile is squish's own default: cluster fit, perceptual metric
+    auto defaulted = LibTXD::TextureConverter::compressToDXT(rgba.data(), 64, 64, LibTXD::Compression::DXT1);
+    ASSERT_NE(defaulted, nullptr);
+    std::vector<uint8_t> direct(size);
+    squish::CompressImage(rgba.data(), 64, 64, direct.data(), squish::kDxt1);
+    EXPECT_EQ(std::memcmp(defaulted.get(), direct.data(), size), 0);
+}
+
+TEST_F(TextureConverterTest, BenchmarkProfiles_InvalidInput_ReturnsEmpty) {
+    EXPECT_TRUE(LibTXD::TextureConverter::benchmarkProfiles(
+        nullptr, 32, 32, LibTXD::Compression::DXT1).empty());
+    
+    auto original = createGradientRGBA(8, 8);
+    EXPECT_TRUE(LibTXD::TextureConverter::benchmarkProfiles(
+        original.data(), 8, 8, LibTXD::Compression::NONE).empty());
+}
+
+TEST_F(TextureConverterTest, TranscodeDXT_DXT1ToDXT3AndBackDecodesIdentically) {
+    auto rgba = createGradientRGBA(16, 16);
+    auto dxt1 = LibTXD::TextureConverter::compressToDXT(rgba.data(), 16, 16, LibTXD::Compression::DXT1);
+    ASSERT_NE(dxt1, nullptr);
+    
+    auto dxt3 = LibTXD::TextureConverter::transcodeDXT(dxt1.get(), 16, 16, LibTXD::Compression::DXT1, LibTXD::Compression::DXT3);
+    ASSERT_NE(dxt3, nullptr);
+    auto back = LibTXD::TextureConverter::transcodeDXT(dxt3.get(), 16, 16, LibTXD::Compression::DXT3, LibTXD::Compression::DXT1);
+    ASSERT_NE(back, nullptr);
+    
+    auto original = LibTXD::TextureConverter::decompressDXT(dxt1.get(), 16, 16, LibTXD::Compression::DXT1);
+    auto viaDXT3 = LibTXD::TextureConverter::decompressDXT(dxt3.get(), 16, 16, LibTXD::Compression::DXT3);
+    auto roundTrip = LibTXD::TextureConverter::decompressDXT(back.get(), 16, 16, LibTXD::Compression::DXT1);
+    EXPECT_EQ(std::memcmp(original.get(), viaDXT3.get(), 16 * 16 * 4), 0);
+    EXPECT_EQ(std::memcmp(original.get(), roundTrip.get(), 16 * 16 * 4), 0);
+}
+
+TEST_F(TextureConverterTest, CompressToDXT_RepeatedBlocksMatchSquish) {
+    // Solid areas, a repeating tile, unique detail and partial edge blocks
+    const uint32_t width = 37, height = 21;
+    auto rgba = createGradientRGBA(width, height);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t* p = &rgba[(y * width + x) * 4];
+            if (x < 12) {
+                p[0] = 30; p[1] = 140; p[2] = 60; p[3] = y < 8 ? 255 : 100;
+            } else if (x < 28) {
+                p[0] = static_cast<uint8_t>((x % 4) * 60);
+                p[1] = static_cast<uint8_t>((y % 4) * 60);
+                p[3] = static_cast<uint8_t>(255 - (x % 4) * 70);
+            }
+        }
+    }
+    
+    const std::pair<LibTXD::Compression, int> formats[] = {
+        { LibTXD::Compression::DXT1, squish::kDxt1 },
+        { LibTXD::Compression::DXT3, squish::kDxt3 },
+        { LibTXD::Compression::DXT5, squish::kDxt5 },
+    };
+    for (const auto& [compression, squishFormat] : formats) {
+        size_t size = LibTXD::TextureConverter::getCompressedDataSize(width, height, compression);
+        std::vector<uint8_t> expected(size);
+        squish::CompressImage(rgba.data(), width, height, expected.data(),
+                              squishFormat | squish::kColourClusterFit | squish::kColourMetricPerceptual);
+        
+        auto compressed = LibTXD::TextureConverter::compressToDXT(rgba.data(), width, height, compression);
+        ASSERT_NE(compressed, nullptr);
+        EXPECT_EQ(std::memcmp(compressed.get(), expected.data(), size), 0)
+            << "compression " << static_cast<int>(compression);
+    }
+}
+
+TEST_F(TextureConverterTest, CompressDXT5_InterpolatedAlphaBeatsDXT3) {
+    auto rgba = createGradientRGBA(16, 16);
+    for (uint32_t i = 0; i < 16 * 16; i++) {
+        // Off the 4-bit grid, so DXT3 has to round
+        rgba[i * 4 + 3] = static_cast<uint8_t>((i % 16) * 16 + 5);
+    }
+    EXPECT_EQ(LibTXD::TextureConverter::getCompressedDataSize(16, 16, LibTXD::Compression::DXT5), 256u);
+    
+    for (auto profile : { LibTXD::CompressionProfile::realtime(), LibTXD::CompressionProfile() }) {
+        LibTXD::QualityMetrics dxt5, dxt3;
+        ASSERT_NE(LibTXD::TextureConverter::compressAndMeasure(
+            rgba.data(), 16, 16, LibTXD::Compression::DXT5, dxt5, profile), nullptr);
+        ASSERT_NE(LibTXD::TextureConverter::compressAndMeasure(
+            rgba.data(), 16, 16, LibTXD::Compression::DXT3, dxt3, profile), nullptr);
+        EXPECT_LT(dxt5.mse[3], dxt3.mse[3]);
+        EXPECT_LE(dxt5.maxError[3], 4);
+        // Both formats share the same colour block encoding
+        EXPECT_DOUBLE_EQ(dxt5.rgbMse, dxt3.rgbMse);
+    }
+}
+
+TEST_F(TextureConverterTest, TranscodeDXT_DXT1PunchThroughToDXT5) {
+    // Colours exact in 565 so squish needs no three-colour midpoint
+    auto rgba = createTestRGBA(16, 16, 255, 0, 0, 255);
+    for (uint32_t i = 0; i < 16 * 16; i += 2) {
+        rgba[i * 4 + 1] = 255;
+    }
+    for (uint32_t i = 0; i < 16 * 16; i++) {
+        rgba[i * 4 + 3] = (i % 3 == 0) ? 0 : 255;
+    }
+    auto dxt1 = LibTXD::TextureConverter::compressToDXT(rgba.data(), 16, 16, LibTXD::Compression::DXT1);
+    ASSERT_NE(dxt1, nullptr);
+    auto dxt5 = LibTXD::TextureConverter::transcodeDXT(dxt1.get(), 16, 16, LibTXD::Compression::DXT1, LibTXD::Compression::DXT5);
+    ASSERT_NE(dxt5, nullptr);
+    
+    // Alpha and every visible colour decode identically
+    auto original = LibTXD::TextureConverter::decompressDXT(dxt1.get(), 16, 16, LibTXD::Compression::DXT1);
+    auto viaDXT5 = LibTXD::TextureConverter::decompressDXT(dxt5.get(), 16, 16, LibTXD::Compression::DXT5);
+    for (uint32_t i = 0; i < 16 * 16; i++) {
+        ASSERT_EQ(original[i * 4 + 3], viaDXT5[i * 4 + 3]) << "pixel " << i;
+        if (original[i * 4 + 3] != 0) {
+            EXPECT_EQ(std::memcmp(&original[i * 4], &viaDXT5[i * 4], 3), 0) << "pixel " << i;
+        }
+    }
+    
+    // Transparency cannot go back to opaque-only DXT1 via DXT5
+    EXPECT_EQ(LibTXD::TextureConverter::transcodeDXT(dxt5.get(), 16, 16, LibTXD::Compression::DXT5,
+                                                      LibTXD::Compression::DXT1), nullptr);
+    
+    // DXT5 to DXT3 keeps the colour block and quantises alpha to 4 bits
+    auto dxt3 = LibTXD::TextureConverter::transcodeDXT(dxt5.get(), 16, 16, LibTXD::Compression::DXT5, LibTXD::Compression::DXT3);
+    ASSERT_NE(dxt3, nullptr);
+    auto viaDXT3 = LibTXD::TextureConverter::decompressDXT(dxt3.get(), 16, 16, LibTXD::Compression::DXT3);
+    EXPECT_EQ(std::memcmp(viaDXT5.get(), viaDXT3.get(), 16 * 16 * 4), 0);
+    
+    // Opaque DXT1 survives a round trip through DXT5
+    auto opaque = createGradientRGBA(16, 16);
+    auto opaqueDXT1 = LibTXD::TextureConverter::compressToDXT(opaque.data(), 16, 16, LibTXD::Compression::DXT1);
+    auto opaqueDXT5 = LibTXD::TextureConverter::transcodeDXT(opaqueDXT1.get(), 16, 16, LibTXD::Compression::DXT1, LibTXD::Compression::DXT5);
+    ASSERT_NE(opaqueDXT5, nullptr);
+    auto back = LibTXD::TextureConverter::transcodeDXT(opaqueDXT5.get(), 16, 16, LibTXD::Compression::DXT5, LibTXD::Compression::DXT1);
+    ASSERT_NE(back, nullptr);
+    auto before = LibTXD::TextureConverter::decompressDXT(opaqueDXT1.get(), 16, 16, LibTXD::Compression::DXT1);
+    auto after = LibTXD::TextureConverter::decompressDXT(back.get(), 16, 16, LibTXD::Compression::DXT1);
+    EXPECT_EQ(std::memcmp(before.get(), after.get(), 16 * 16 * 4), 0);
+}
+
+TEST_F(TextureConverterTest, TranscodeDXT_DXT3ToDXT1FixesEndpointOrder) {
+    // Opaque DXT3 block with colour0 < colour1, which DXT1 would read as three-colour
+    uint8_t block[16];
+    std::memset(block, 0xFF, 8);
+    uint16_t c0 = 0x001F, c1 = 0xF800;
+    block[8] = c0 & 0xFF; block[9] = c0 >> 8;
+    block[10] = c1 & 0xFF; block[11] = c1 >> 8;
+    block[12] = 0xE4; block[13] = 0xE4; block[14] = 0xE4; block[15] = 0xE4;  // Indices 0,1,2,3 per row
+    
+    auto dxt1 = LibTXD::TextureConverter::transcodeDXT(block, 4, 4, LibTXD::Compression::DXT3, LibTXD::Compression::DXT1);
+    ASSERT_NE(dxt1, nullptr);
+    auto expected = LibTXD::TextureConverter::decompressDXT(block, 4, 4, LibTXD::Compression::DXT3);
+    auto actual = LibTXD::TextureConverter::decompressDXT(dxt1.get(), 4, 4, LibTXD::Compression::DXT1);
+    EXPECT_EQ(std::memcmp(expected.get(), actual.get(), 64), 0);
+    
+    // Any translucent alpha makes the conversion lossy, so it is refused
+    block[3] = 0x7F;
+    EXPECT_EQ(LibTXD::TextureConverter::transcodeDXT(block, 4, 4, LibTXD::Compression::DXT3, LibTXD::Compression::DXT1), nullptr);
+}
+
+TEST_F(TextureConverterTest, TranscodeTexture_KeepsPunchThroughAlpha) {
+    auto rgba = createTestRGBA(8, 8, 40, 160, 220, 255);
+    for (size_t i = 0; i < 8 * 8; i += 3) {
+        rgba[i * 4 + 3] = 0;
+    }
+    auto dxt1 = LibTXD::TextureConverter::compressToDXT(rgba.data(), 8, 8, LibTXD::Compression::DXT1);
+    ASSERT_NE(dxt1, nullptr);
+    
+    LibTXD::Texture texture;
+    texture.setCompression(LibTXD::Compression::DXT1);
+    texture.setRasterFormat(static_cast<LibTXD::RasterFormat>(
+        static_cast<uint32_t>(LibTXD::RasterFormat::A1R5G5B5) | static_cast<uint32_t>(LibTXD::RasterFormat::MIPMAP)));
+    texture.setHasAlpha(true);
+    LibTXD::MipmapLevel mip;
+    mip.width = 8;
+    mip.height = 8;
+    mip.data.assign(dxt1.get(), dxt1.get() + 32);
+    mip.dataSize = 32;
+    texture.addMipmap(std::move(mip));
+    
+    ASSERT_TRUE(LibTXD::TextureConverter::transcodeTexture(texture, LibTXD::Compression::DXT3));
+    EXPECT_EQ(texture.getCompression(), LibTXD::Compression::DXT3);
+    EXPECT_EQ(texture.getMipmap(0).dataSize, 64u);
+    EXPECT_EQ(static_cast<uint32_t>(texture.getRasterFormat()),
+              static_cast<uint32_t>(LibTXD::RasterFormat::R4G4B4A4) | static_cast<uint32_t>(LibTXD::RasterFormat::MIPMAP));
+    
+    auto decoded = LibTXD::TextureConverter::convertToRGBA8(texture, 0);
+    ASSERT_NE(decoded, nullptr);
+    for (size_t i = 0; i < 8 * 8; i++) {
+        EXPECT_EQ(decoded[i * 4 + 3], i % 3 == 0 ? 0 : 255) << "Pixel " << i;
+    }
+    
+    // Translucent DXT3 cannot become DXT1
+    EXPECT_FALSE(LibTXD::TextureConverter::transcodeTexture(texture, LibTXD::Compression::DXT1));
+    EXPECT_EQ(texture.getCompression(), LibTXD::Compression::DXT3);
+}
+
+TEST_F(TextureConverterTest, CompressBatch_MatchesSerialCompression) {
+    // The tall texture spans several bands and ends in a partial block row
+    auto tall = createGradientRGBA(20, 150);
+    auto small = createGradientRGBA(8, 8);
+    auto solid = createTestRGBA(4, 4, 10, 20, 30, 255);
+    
+    std::vector<LibTXD::CompressionJob> jobs = {
+        { tall.data(), 20, 150, LibTXD::Compression::DXT1, LibTXD::CompressionProfile::rangeFit() },
+        { small.data(), 8, 8, LibTXD::Compression::DXT3, LibTXD::CompressionProfile::clusterFit() },
+        { solid.data(), 4, 4, LibTXD::Compression::DXT1, LibTXD::CompressionProfile::realtime() },
+    };
+    
+    auto results = LibTXD::TextureConverter::compressBatch(jobs, 2);
+    ASSERT_EQ(results.size(), jobs.size());
+    
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const auto& job = jobs[i];
+        auto expected = LibTXD::TextureConverter::compressToDXT(job.rgba, job.width, job.height,
+                                                                job.compression, job.profile);
+        ASSERT_NE(expected, nullptr);
+        size_t size = LibTXD::TextureConverter::getCompressedDataSize(job.width, job.height, job.compression);
+        ASSERT_EQ(results[i].size(), size) << "Job " << i;
+        EXPECT_EQ(std::memcmp(results[i].data(), expected.get(), size), 0) << "Job " << i;
+    }
+}
+
+TEST_F(TextureConverterTest, CompressBatch_InvalidJobYieldsEmptyBuffer) {
+    auto rgba = createTestRGBA(8, 8, 255, 0, 0, 255);
+    std::vector<LibTXD::CompressionJob> jobs = {
+        { nullptr, 8, 8, LibTXD::Compression::DXT1, LibTXD::CompressionProfile() },
+        { rgba.data(), 8, 8, LibTXD::Compression::NONE, LibTXD::CompressionProfile() },
+        { rgba.data(), 8, 8, LibTXD::Compression::DXT1, LibTXD::CompressionProfile() },
+    };
+    
+    auto results = LibTXD::TextureConverter::compressBatch(jobs);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_TRUE(results[0].empty());
+    EXPECT_TRUE(results[1].empty());
+    EXPECT_EQ(results[2].size(), 32u);
+    EXPECT_TRUE(LibTXD::TextureConverter::compressBatch({}).empty());
+}
+
+TEST_F(TextureConverterTest, MeasureQuality_PerChannelErrors) {
+    // 5 pixels: vectorised group of four plus a scalar tail
+    auto reference = createTestRGBA(5, 1, 100, 100, 100, 255);
+    auto test = reference;
+    test[0] = 110;       // R of pixel 0: +10
+    test[4 * 4 + 1] = 97;  // G of pixel 4: -3
+    
+    auto metrics = LibTXD::TextureConverter::measureQuality(reference.data(), test.data(), 5, 1);
+    EXPECT_DOUBLE_EQ(metrics.mse[0], 100.0 / 5);
+    EXPECT_DOUBLE_EQ(metrics.mse[1], 9.0 / 5);
+    EXPECT_DOUBLE_EQ(metrics.mse[2], 0.0);
+    EXPECT_EQ(metrics.maxError[0], 10);
+    EXPECT_EQ(metrics.maxError[1], 3);
+    EXPECT_EQ(metrics.maxError[3], 0);
+    EXPECT_TRUE(std::isinf(metrics.psnr[3]));
+    EXPECT_NEAR(metrics.rgbPsnr, 10.0 * std::log10(255.0 * 255.0 / (109.0 / 15)), 1e-9);
+    
+    auto identical = LibTXD::TextureConverter::measureQuality(reference.data(), reference.data(), 5, 1);
+    EXPECT_DOUBLE_EQ(identical.ssim, 1.0);
+    EXPECT_DOUBLE_EQ(identical.alphaSsim, 1.0);
+}
+
+TEST_F(TextureConverterTest, MeasureQuality_SSIMIgnoresColourUnderTransparency) {
+    auto reference = createGradientRGBA(16, 16);
+    for (size_t i = 0; i < 16 * 16; i++) {
+        reference[i * 4 + 3] = 0;
+    }
+    auto test = reference;
+    for (size_t i = 0; i < 16 * 16; i++) {
+        test[i * 4 + 0] = static_cast<uint8_t>(255 - test[i * 4 + 0]);
+    }
+    
+    auto metrics = LibTXD::TextureConverter::measureQuality(reference.data(), test.data(), 16, 16);
+    EXPECT_GT(metrics.mse[0], 0.0);
+    EXPECT_DOUBLE_EQ(metrics.ssim, 1.0);
+    
+    // Once visible the same change is heavily penalised
+    for (size_t i = 0; i < 16 * 16; i++) {
+        reference[i * 4 + 3] = test[i * 4 + 3] = 255;
+    }
+    metrics = LibTXD::TextureConverter::measureQuality(reference.data(), test.data(), 16, 16);
+    EXPECT_LT(metrics.ssim, 0.9);
+}
+
+TEST_F(TextureConverterTest, CompressAndMeasure_ReportsDXTError) {
+    auto rgba = createGradientRGBA(32, 32);
+    LibTXD::QualityMetrics metrics;
+    auto compressed = LibTXD::TextureConverter::compressAndMeasure(
+        rgba.data(), 32, 32, LibTXD::Compression::DXT1, metrics);
+    ASSERT_NE(compressed, nullptr);
+    
+    auto decoded = LibTXD::TextureConverter::decompressDXT(compressed.get(), 32, 32, LibTXD::Compression::DXT1);
+    auto expected = LibTXD::TextureConverter::measureQuality(rgba.data(), decoded.get(), 32, 32);
+    EXPECT_DOUBLE_EQ(metrics.rgbMse, expected.rgbMse);
+    EXPECT_GT(metrics.rgbPsnr, 30.0);
+    EXPECT_GT(metrics.ssim, 0.9);
+    EXPECT_LE(metrics.maxError[0], 16);
+    
+    EXPECT_EQ(LibTXD::TextureConverter::compressAndMeasure(
+        rgba.data(), 32, 32, LibTXD::Compression::NONE, metrics), nullptr);
+}
+
+TEST_F(TextureConverterTest, AnalyzeTexture_ClassifiesAlphaAndColours) {
+    // 15 pixels: three vectorised groups of four plus a scalar tail
+    auto rgba = createTestRGBA(5, 3, 200, 200, 200, 255);
+    auto analysis = LibTXD::TextureConverter::analyzeTexture(rgba.data(), 5, 3);
+    EXPECT_EQ(analysis.alpha, LibTXD::AlphaClass::Opaque);
+    EXPECT_EQ(analysis.colourCount, 1u);
+    EXPECT_TRUE(analysis.grayscale);
+    
+    rgba[14 * 4 + 3] = 0;
+    analysis = LibTXD::TextureConverter::analyzeTexture(rgba.data(), 5, 3);
+    EXPECT_EQ(analysis.alpha, LibTXD::AlphaClass::OneBit);
+    EXPECT_EQ(analysis.colourCount, 2u);
+    
+    rgba[1 * 4 + 3] = 128;
+    rgba[2 * 4 + 0] = 10;
+    analysis = LibTXD::TextureConverter::analyzeTexture(rgba.data(), 5, 3);
+    EXPECT_EQ(analysis.alpha, LibTXD::AlphaClass::Smooth);
+    EXPECT_FALSE(analysis.grayscale);
+    
+    auto gradient = createGradientRGBA(32, 32);
+    EXPECT_EQ(LibTXD::TextureConverter::analyzeTexture(gradient.data(), 32, 32).colourCount, 257u);
+}
+
+TEST_F(TextureConverterTest, ChannelKernels_SplitAndMergeRoundTrip) {
+    // 37 pixels: two vectorised groups of sixteen plus a scalar tail
+    const size_t pixelCount = 37;
+    std::vector<uint8_t> rgba(pixelCount * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+    
+    std::vector<uint8_t> alpha(pixelCount), rgb(pixelCount * 3), luminance(pixelCount);
+    LibTXD::TextureConverter::extractAlpha(rgba.data(), pixelCount, alpha.data());
+    LibTXD::TextureConverter::stripAlpha(rgba.data(), pixelCount, rgb.data());
+    LibTXD::TextureConverter::extractLuminance(rgba.data(), pixelCount, luminance.data());
+    for (size_t i = 0; i < pixelCount; i++) {
+        const uint8_t* p = &rgba[i * 4];
+        EXPECT_EQ(alpha[i], p[3]);
+        EXPECT_EQ(rgb[i * 3 + 0], p[0]);
+        EXPECT_EQ(rgb[i * 3 + 1], p[1]);
+        EXPECT_EQ(rgb[i * 3 + 2], p[2]);
+        EXPECT_EQ(luminance[i], (77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+    
+    // Inserting a new plane changes only the alpha bytes
+    std::vector<uint8_t> merged = rgba;
+    std::vector<uint8_t> plane(pixelCount);
+    for (size_t i = 0; i < pixelCount; i++) {
+        plane[i] = static_cast<uint8_t>(255 - i);
+    }
+    LibTXD::TextureConverter::insertAlpha(merged.data(), pixelCount, plane.data());
+    for (size_t i = 0; i < pixelCount; i++) {
+        EXPECT_EQ(merged[i * 4 + 3], plane[i]);
+        EXPECT_EQ(std::memcmp(&merged[i * 4], &rgba[i * 4], 3), 0);
+    }
+}
+
+TEST_F(TextureConverterTest, ClassifyAlpha_MatchesAnalysis) {
+    // 40 pixels so the odd values land in both the vector body and the tail
+    auto rgba = createTestRGBA(8, 5, 10, 20, 30, 255);
+    EXPECT_EQ(LibTXD::TextureConverter::classifyAlpha(rgba.data(), 40), LibTXD::AlphaClass::Opaque);
+    
+    rgba[39 * 4 + 3] = 0;
+    EXPECT_EQ(LibTXD::TextureConverter::classifyAlpha(rgba.data(), 40), LibTXD::AlphaClass::OneBit);
+    rgba[5 * 4 + 3] = 0;
+    EXPECT_EQ(LibTXD::TextureConverter::classifyAlpha(rgba.data(), 40), LibTXD::AlphaClass::OneBit);
+    
+    rgba[20 * 4 + 3] = 128;
+    EXPECT_EQ(LibTXD::TextureConverter::classifyAlpha(rgba.data(), 40), LibTXD::AlphaClass::Smooth);
+    EXPECT_EQ(LibTXD::TextureConverter::analyzeTexture(rgba.data(), 8, 5).alpha, LibTXD::AlphaClass::Smooth);
+    
+    rgba[20 * 4 + 3] = 255;
+    rgba[34 * 4 + 3] = 1;
+    EXPECT_EQ(LibTXD::TextureConverter::classifyAlpha(rgba.data(), 40), LibTXD::AlphaClass::Smooth);
+}
+
+TEST_F(TextureConverterTest, SelectFormat_PicksSmallestFormatForContent) {
+    auto opaque = createTestRGBA(16, 16, 255, 0, 0, 255);
+    auto choice = LibTXD::TextureConverter::selectFormat(opaque.data(), 16, 16);
+    EXPECT_EQ(choice.name, "DXT1");
+    EXPECT_EQ(choice.compression, LibTXD::Compression::DXT1);
+    EXPECT_EQ(choice.bytes, 128u);
+    
+    // Cut-out: punch-through alpha keeps 4 bits per pixel
+    auto cutout = opaque;
+    auto smooth = opaque;
+    for (uint32_t y = 0; y < 16; y++) {
+        for (uint32_t x = 0; x < 16; x++) {
+            cutout[(y * 16 + x) * 4 + 3] = x < 8 ? 0 : 255;
+            smooth[(y * 16 + x) * 4 + 3] = static_cast<uint8_t>(x * 17);
+        }
+    }
+    choice = LibTXD::TextureConverter::selectFormat(cutout.data(), 16, 16);
+    EXPECT_EQ(choice.name, "DXT1a");
+    EXPECT_EQ(choice.compression, LibTXD::Compression::DXT1);
+    
+    choice = LibTXD::TextureConverter::selectFormat(smooth.data(), 16, 16);
+    EXPECT_EQ(choice.name, "DXT5");
+    EXPECT_GE(choice.metrics.psnr[3], 30.0);
+    
+    // Without DXT a two-colour image fits a 16-colour palette
+    auto checker = opaque;
+    for (size_t i = 0; i < 16 * 16; i += 2) {
+        checker[i * 4 + 0] = 0;
+        checker[i * 4 + 2] = 255;
+    }
+    LibTXD::FormatSelectionOptions options;
+    options.allowDXT = false;
+    choice = LibTXD::TextureConverter::selectFormat(checker.data(), 16, 16, options);
+    EXPECT_EQ(choice.name, "PAL4");
+    EXPECT_EQ(choice.paletteSize, 16u);
+    EXPECT_NE(static_cast<uint32_t>(choice.rasterFormat) & static_cast<uint32_t>(LibTXD::RasterFormat::PAL4), 0u);
+    EXPECT_EQ(choice.bytes, 16u * 16u + 64u);
+    
+    // An unreachable target falls back to lossless 24-bit
+    auto gradient = createGradientRGBA(16, 16);
+    options.minPsnr = std::numeric_limits<double>::infinity();
+    choice = LibTXD::TextureConverter::selectFormat(gradient.data(), 16, 16, options);
+    EXPECT_EQ(choice.name, "B8G8R8");
+    EXPECT_EQ(choice.bytes, 16u * 16u * 3u);
+    EXPECT_TRUE(std::isinf(choice.psnr));
+    
+    EXPECT_TRUE(LibTXD::TextureConverter::selectFormat(nullptr, 16, 16).name.empty());
+}
+
+TEST_F(TextureConverterTest, FormatSelectionReport_Totals) {
+    LibTXD::FormatSelectionReport report;
+    report.entries.push_back({ "road", "DXT1", 4096, 2048, 40.0 });
+    report.entries.push_back({ "sky", "PAL8", 1024, 1600, 38.0 });
+    EXPECT_EQ(report.getOriginalBytes(), 5120u);
+    EXPECT_EQ(report.getSelectedBytes(), 3648u);
+    EXPECT_EQ(report.getBytesSaved(), 1472);
+    
+    std::string text = report.toString();
+    EXPECT_NE(text.find("road"), std::string::npos);
+    EXPECT_NE(text.find("Total: 5120 -> 3648 bytes, 1472 saved"), std::string::npos);
+}
+
+TEST_F(TextureConverterTest, OptimizeForBudget_FitsBudgetAndTradesError) {
+    // Flat, smooth and noisy content: the noise should keep the most bytes
+    auto flat = createTestRGBA(64, 64, 90, 140, 30, 255);
+    auto gradient = createGradientRGBA(64, 64);
+    std::vector<uint8_t> noise(64 * 64 * 4);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < noise.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        noise[i] = (i % 4 == 3) ? 255 : static_cast<uint8_t>(seed >> 24);
+    }
+    std::vector<LibTXD::ImageView> images = {
+        { flat.data(), 64, 64 }, { gradient.data(), 64, 64 }, { noise.data(), 64, 64 }
+    };
+    
+    LibTXD::BudgetOptions options;
+    options.allowPalette = false;  // Keeps the test fast
+    options.budgetBytes = 16 * 1024;
+    auto plan = LibTXD::TextureConverter::optimizeForBudget(images, options);
+    ASSERT_EQ(plan.choices.size(), 3u);
+    EXPECT_TRUE(plan.withinBudget);
+    EXPECT_LE(plan.totalBytes, options.budgetBytes);
+    
+    size_t bytes = 0;
+    for (const auto& choice : plan.choices) {
+        bytes += choice.bytes;
+        EXPECT_EQ(choice.width, 64u >> choice.downscaleLevels);
+    }
+    EXPECT_EQ(bytes, plan.totalBytes);
+    EXPECT_GE(plan.choices[2].bytes, plan.choices[0].bytes);
+    
+    // A bigger budget never costs quality; an impossible one is reported
+    options.budgetBytes = 64 * 1024;
+    auto generous = LibTXD::TextureConverter::optimizeForBudget(images, options);
+    EXPECT_TRUE(generous.withinBudget);
+    EXPECT_LE(generous.totalError, plan.totalError);
+    options.budgetBytes = 100;
+    EXPECT_FALSE(LibTXD::TextureConverter::optimizeForBudget(images, options).withinBudget);
+}
+
+TEST_F(TextureConverterTest, ApplyBudgetCandidate_BuildsPlannedTexture) {
+    auto rgba = createGradientRGBA(64, 32);
+    LibTXD::BudgetOptions options;
+    options.allowPalette = false;
+    options.budgetBytes = 1200;
+    auto plan = LibTXD::TextureConverter::optimizeForBudget({ { rgba.data(), 64, 32 } }, options);
+    ASSERT_EQ(plan.choices.size(), 1u);
+    ASSERT_TRUE(plan.withinBudget);
+    const auto& choice = plan.choices[0];
+    
+    LibTXD::Texture texture;
+    texture.setName("road");
+    texture.setPlatform(LibTXD::Platform::D3D9);
+    ASSERT_TRUE(LibTXD::TextureConverter::applyBudgetCandidate(texture, rgba.data(), 64, 32, choice, options));
+    EXPECT_EQ(texture.getName(), "road");
+    EXPECT_EQ(texture.getCompression(), choice.format.compression);
+    ASSERT_GT(texture.getMipmapCount(), 1u);
+    EXPECT_EQ(texture.getMipmap(0).width, choice.width);
+    EXPECT_EQ(texture.getMipmap(0).height, choice.height);
+    
+    size_t stored = texture.getPalette().size();
+    for (uint32_t level = 0; level < texture.getMipmapCount(); level++) {
+        stored += texture.getMipmap(level).data.size();
+    }
+    EXPECT_EQ(stored, choice.bytes);
+    EXPECT_TRUE(LibTXD::TextureConverter::canConvert(texture));
+}
+
 TEST_F(TextureConverterTest, ConvertToRGBA8_UncompressedTexture) {
     LibTXD::Texture texture;
     texture.setRasterFormat(LibTXD::RasterFormat::B8G8R8A8);
@@ -755,10 +1730,11 @@ TEST_F(TextureConverterTest, ConvertToRGBA8_UncompressedTexture) {
     mip.data.resize(mip.dataSize);
     
     // Set first pixel to blue (BGRA = B, G, R, A)
-    mip.data[0] = 255;  // B
-    mip.data[1] = 0;    // G
-    mip.data[2] = 0;    // R
-    mip.data[3] = 255;  // A
+    uint8_t* pixels = mip.data.mutableData();
+    pixels[0] = 255;  // B
+    pixels[1] = 0;    // G
+    pixels[2] = 0;    // R
+    pixels[3] = 255;  // A
     
     texture.addMipmap(std::move(mip));
     
@@ -808,6 +1784,94 @@ TEST_F(TextureConverterTest, ConvertToRGBA8_CompressedTexture) {
     EXPECT_TRUE(hasNonZeroData) << "Converted image appears to be all zeros";
 }
 
+TEST_F(TextureConverterTest, EncodeUncompressed_16BitRoundtripThroughDecoder) {
+    // 7 pixels wide: vectorised groups of four plus a scalar tail
+    const uint32_t width = 7, height = 3;
+    std::vector<uint8_t> rgba(width * height * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    
+    struct Case { LibTXD::RasterFormat format; int levels[4]; };
+    const Case cases[] = {
+        { LibTXD::RasterFormat::R5G6B5, { 31, 63, 31, 0 } },
+        { LibTXD::RasterFormat::A1R5G5B5, { 31, 31, 31, 1 } },
+        { LibTXD::RasterFormat::R4G4B4A4, { 15, 15, 15, 15 } },
+    };
+    
+    for (const auto& c : cases) {
+        ASSERT_EQ(LibTXD::TextureConverter::getUncompressedPixelSize(c.format), 2u);
+        
+        LibTXD::Texture texture;
+        texture.setRasterFormat(c.format);
+        texture.setDepth(16);
+        LibTXD::MipmapLevel mip;
+        mip.width = width;
+        mip.height = height;
+        mip.data.resize(width * height * 2);
+        mip.dataSize = static_cast<uint32_t>(mip.data.size());
+        ASSERT_TRUE(LibTXD::TextureConverter::encodeUncompressed(rgba.data(), width, height, c.format, mip.data.mutableData()));
+        texture.addMipmap(std::move(mip));
+        
+        auto decoded = LibTXD::TextureConverter::convertToRGBA8(texture, 0);
+        ASSERT_NE(decoded, nullptr);
+        for (size_t i = 0; i < width * height; i++) {
+            for (int ch = 0; ch < 4; ch++) {
+                int levels = c.levels[ch];
+                int expected = 255;
+                if (levels > 0) {
+                    int q = (rgba[i * 4 + ch] * levels + 127) / 255;
+                    expected = (q * 255 + levels / 2) / levels;
+                }
+                EXPECT_NEAR(decoded[i * 4 + ch], expected, 1) << "Pixel " << i << " channel " << ch;
+            }
+        }
+    }
+}
+
+TEST_F(TextureConverterTest, EncodeUncompressed_DitheringPreservesMeanColour) {
+    // 100 is between two 4-bit levels (85 and 102); dithering mixes them
+    auto rgba = createTestRGBA(16, 16, 100, 100, 100, 255);
+    
+    for (auto dither : { LibTXD::DitherMode::None, LibTXD::DitherMode::Ordered, LibTXD::DitherMode::ErrorDiffusion }) {
+        std::vector<uint8_t> encoded(16 * 16 * 2);
+        ASSERT_TRUE(LibTXD::TextureConverter::encodeUncompressed(
+            rgba.data(), 16, 16, LibTXD::RasterFormat::R4G4B4A4, encoded.data(), dither));
+        
+        double sum = 0.0;
+        for (size_t i = 0; i < 16 * 16; i++) {
+            int pixel = encoded[i * 2] | (encoded[i * 2 + 1] << 8);
+            EXPECT_EQ(pixel >> 12, 15);  // Opaque alpha
+            sum += ((pixel >> 8) & 0xF) * 17;
+        }
+        double mean = sum / (16 * 16);
+        if (dither == LibTXD::DitherMode::None) {
+            EXPECT_DOUBLE_EQ(mean, 102.0);
+        } else {
+            EXPECT_NEAR(mean, 100.0, 1.0);
+        }
+    }
+}
+
+TEST_F(TextureConverterTest, EncodeUncompressed_Luminance) {
+    std::vector<uint8_t> rgba = {
+        255, 255, 255, 255,   0, 0, 0, 255,   255, 0, 0, 255,
+        0, 255, 0, 255,       0, 0, 255, 255
+    };
+    std::vector<uint8_t> lum(5);
+    ASSERT_TRUE(LibTXD::TextureConverter::encodeUncompressed(
+        rgba.data(), 5, 1, LibTXD::RasterFormat::LUM8, lum.data()));
+    EXPECT_EQ(lum[0], 255);
+    EXPECT_EQ(lum[1], 0);
+    EXPECT_EQ(lum[2], 77);
+    EXPECT_EQ(lum[3], 149);
+    EXPECT_EQ(lum[4], 29);
+    
+    EXPECT_EQ(LibTXD::TextureConverter::getUncompressedPixelSize(LibTXD::RasterFormat::PAL8), 0u);
+    EXPECT_FALSE(LibTXD::TextureConverter::encodeUncompressed(
+        rgba.data(), 5, 1, LibTXD::RasterFormat::DEFAULT, lum.data()));
+}
+
 TEST_F(TextureConverterTest, CanConvert_SupportedFormats) {
     LibTXD::Texture texNone;
     texNone.setCompression(LibTXD::Compression::NONE);
@@ -850,6 +1914,88 @@ TEST_F(TextureConverterTest, GeneratePalette_PAL4) {
     EXPECT_EQ(indexedData.size(), 16u * 16);
 }
 
+TEST_F(TextureConverterTest, GeneratePalette_WithOptions) {
+    auto rgba = createGradientRGBA(64, 64);
+    
+    LibTXD::PaletteOptions options;
+    options.speed = 10;
+    options.ditheringLevel = 0.0f;
+    options.threadCount = 2;
+    
+    std::vector<uint8_t> palette;
+    std::vector<uint8_t> indexedData;
+    ASSERT_TRUE(LibTXD::TextureConverter::generatePalette(
+        rgba.data(), 64, 64, 256, palette, indexedData, options));
+    EXPECT_EQ(palette.size(), 256u * 4);
+    EXPECT_EQ(indexedData.size(), 64u * 64);
+}
+
+TEST_F(TextureConverterTest, GeneratePalette_UnreachableQuality_Fails) {
+    auto rgba = createGradientRGBA(64, 64);
+    
+    LibTXD::PaletteOptions options;
+    options.minQuality = 100;
+    
+    std::vector<uint8_t> palette;
+    std::vector<uint8_t> indexedData;
+    EXPECT_FALSE(LibTXD::TextureConverter::generatePalette(
+        rgba.data(), 64, 64, 16, palette, indexedData, options));
+    
+    options.minQuality = 80;
+    options.maxQuality = 20;
+    EXPECT_FALSE(LibTXD::TextureConverter::generatePalette(
+        rgba.data(), 64, 64, 256, palette, indexedData, options));
+}
+
+TEST_F(TextureConverterTest, GenerateSharedPalette_RemapsEveryImage) {
+    auto red = createTestRGBA(8, 8, 255, 0, 0, 255);
+    auto blue = createTestRGBA(16, 4, 0, 0, 255, 255);
+    auto gradient = createGradientRGBA(32, 32);
+    
+    std::vector<LibTXD::ImageView> images = {
+        { red.data(), 8, 8 },
+        { blue.data(), 16, 4 },
+        { gradient.data(), 32, 32 }
+    };
+    
+    std::vector<uint8_t> palette;
+    std::vector<std::vector<uint8_t>> indexedData;
+    ASSERT_TRUE(LibTXD::TextureConverter::generateSharedPalette(
+        images, 256, palette, indexedData));
+    
+    EXPECT_EQ(palette.size(), 256u * 4);
+    ASSERT_EQ(indexedData.size(), 3u);
+    EXPECT_EQ(indexedData[0].size(), 8u * 8);
+    EXPECT_EQ(indexedData[1].size(), 16u * 4);
+    EXPECT_EQ(indexedData[2].size(), 32u * 32);
+    
+    // Solid images reconstruct through the shared palette
+    std::vector<uint8_t> output(8 * 8 * 4);
+    LibTXD::TextureConverter::convertPaletteToRGBA(
+        indexedData[0].data(), palette.data(), 256, 8, 8, output.data());
+    EXPECT_NEAR(output[0], 255, 2);
+    EXPECT_NEAR(output[2], 0, 2);
+    
+    output.resize(16 * 4 * 4);
+    LibTXD::TextureConverter::convertPaletteToRGBA(
+        indexedData[1].data(), palette.data(), 256, 16, 4, output.data());
+    EXPECT_NEAR(output[0], 0, 2);
+    EXPECT_NEAR(output[2], 255, 2);
+}
+
+TEST_F(TextureConverterTest, GenerateSharedPalette_InvalidInput_Fails) {
+    std::vector<uint8_t> palette;
+    std::vector<std::vector<uint8_t>> indexedData;
+    EXPECT_FALSE(LibTXD::TextureConverter::generateSharedPalette(
+        {}, 256, palette, indexedData));
+    
+    auto rgba = createTestRGBA(4, 4, 1, 2, 3, 255);
+    EXPECT_FALSE(LibTXD::TextureConverter::generateSharedPalette(
+        { { rgba.data(), 4, 4 }, { nullptr, 4, 4 } }, 256, palette, indexedData));
+    EXPECT_FALSE(LibTXD::TextureConverter::generateSharedPalette(
+        { { rgba.data(), 4, 4 } }, 100, palette, indexedData));
+}
+
 TEST_F(TextureConverterTest, ConvertPaletteToRGBA_ReconstructsImage) {
     // Create simple indexed data
     uint32_t width = 4;
@@ -887,6 +2033,523 @@ TEST_F(TextureConverterTest, ConvertPaletteToRGBA_ReconstructsImage) {
     EXPECT_EQ(output[greenIdx + 2], 0);
 }
 
+TEST_F(TextureConverterTest, ConvertPaletteToRGBA_OutOfRangeIndexUsesEntryZero) {
+    std::vector<uint8_t> palette = {
+        10, 20, 30, 40,
+        50, 60, 70, 80
+    };
+    
+    // 11 pixels exercises both the unrolled body and the tail
+    std::vector<uint8_t> indexedData = { 1, 0, 1, 200, 1, 1, 1, 1, 0, 255, 1 };
+    std::vector<uint8_t> output(indexedData.size() * 4);
+    
+    LibTXD::TextureConverter::convertPaletteToRGBA(
+        indexedData.data(), palette.data(), 2, 11, 1, output.data());
+    
+    for (size_t i = 0; i < indexedData.size(); i++) {
+        uint8_t expected = indexedData[i] == 1 ? 1 : 0;
+        EXPECT_EQ(output[i * 4 + 0], palette[expected * 4 + 0]) << "Pixel " << i;
+        EXPECT_EQ(output[i * 4 + 3], palette[expected * 4 + 3]) << "Pixel " << i;
+    }
+}
+
+TEST_F(TextureConverterTest, ConvertPalette4ToRGBA_UnpacksNibbles) {
+    std::vector<uint8_t> palette(16 * 4);
+    for (uint8_t i = 0; i < 16; i++) {
+        palette[i * 4 + 0] = i * 16;
+        palette[i * 4 + 1] = 255 - i;
+        palette[i * 4 + 2] = i;
+        palette[i * 4 + 3] = 255;
+    }
+    
+    // 3x2 image: rows are 2 bytes each, low nibble first
+    std::vector<uint8_t> packed = { 0x21, 0x03, 0x54, 0x0F };
+    const uint8_t expected[] = { 1, 2, 3, 4, 5, 15 };
+    std::vector<uint8_t> output(3 * 2 * 4);
+    
+    LibTXD::TextureConverter::convertPalette4ToRGBA(
+        packed.data(), palette.data(), 16, 3, 2, output.data());
+    
+    for (size_t i = 0; i < 6; i++) {
+        EXPECT_EQ(output[i * 4 + 0], expected[i] * 16) << "Pixel " << i;
+        EXPECT_EQ(output[i * 4 + 2], expected[i]) << "Pixel " << i;
+    }
+}
+
+TEST_F(TextureConverterTest, ConvertToRGBA8_PackedPAL4Texture) {
+    std::vector<uint8_t> palette(16 * 4, 0);
+    palette[1 * 4 + 0] = 255;  // Index 1: red
+    palette[1 * 4 + 3] = 255;
+    palette[2 * 4 + 2] = 255;  // Index 2: blue
+    palette[2 * 4 + 3] = 255;
+    
+    LibTXD::Texture texture;
+    texture.setRasterFormat(static_cast<LibTXD::RasterFormat>(
+        static_cast<uint32_t>(LibTXD::RasterFormat::PAL4) | static_cast<uint32_t>(LibTXD::RasterFormat::B8G8R8A8)));
+    texture.setDepth(4);
+    texture.setPalette(palette, 16);
+    
+    LibTXD::MipmapLevel mip;
+    mip.width = 4;
+    mip.height = 4;
+    mip.data.assign(8, 0x21);
+    mip.dataSize = 8;
+    texture.addMipmap(std::move(mip));
+    
+    auto rgba = LibTXD::TextureConverter::convertToRGBA8(texture, 0);
+    ASSERT_NE(rgba, nullptr);
+    EXPECT_EQ(rgba[0], 255);   // Pixel 0 red
+    EXPECT_EQ(rgba[6], 255);   // Pixel 1 blue
+    EXPECT_EQ(rgba[15 * 4 + 2], 255);
+}
+
+TEST_F(TextureConverterTest, DecodeRegion_MatchesFullDecode) {
+    // Odd sizes so rectangles cut through partial DXT blocks and PAL4 bytes
+    const uint32_t width = 21, height = 13;
+    auto rgba = createGradientRGBA(width, height);
+    
+    auto makeTexture = [&](LibTXD::RasterFormat format, LibTXD::Compression compression, uint32_t depth,
+                           std::vector<uint8_t> data) {
+        LibTXD::Texture texture;
+        texture.setRasterFormat(format);
+        texture.setCompression(compression);
+        texture.setDepth(depth);
+        LibTXD::MipmapLevel mip;
+        mip.width = width;
+        mip.height = height;
+        mip.dataSize = static_cast<uint32_t>(data.size());
+        mip.data = std::move(data);
+        texture.addMipmap(std::move(mip));
+        return texture;
+    };
+    
+    std::vector<LibTXD::Texture> textures;
+    for (auto compression : { LibTXD::Compression::DXT1, LibTXD::Compression::DXT5 }) {
+        size_t size = LibTXD::TextureConverter::getCompressedDataSize(width, height, compression);
+        auto dxt = LibTXD::TextureConverter::compressToDXT(rgba.data(), width, height, compression,
+                                                           LibTXD::CompressionProfile::realtime());
+        ASSERT_NE(dxt, nullptr);
+        textures.push_back(makeTexture(LibTXD::RasterFormat::B8G8R8A8, compression, 16,
+                                       std::vector<uint8_t>(dxt.get(), dxt.get() + size)));
+    }
+    std::vector<uint8_t> r5g6b5(width * height * 2);
+    ASSERT_TRUE(LibTXD::TextureConverter::encodeUncompressed(rgba.data(), width, height,
+                                                             LibTXD::RasterFormat::R5G6B5, r5g6b5.data()));
+    textures.push_back(makeTexture(LibTXD::RasterFormat::R5G6B5, LibTXD::Compression::NONE, 16, r5g6b5));
+    
+    std::vector<uint8_t> palette(256 * 4);
+    for (size_t i = 0; i < palette.size(); i++) {
+        palette[i] = static_cast<uint8_t>(i * 13);
+    }
+    std::vector<uint8_t> indices(width * height), packed(((width + 1) / 2) * height);
+    for (size_t i = 0; i < indices.size(); i++) {
+        indices[i] = static_cast<uint8_t>(i * 7);
+        size_t row = i / width, col = i % width;
+        packed[row * ((width + 1) / 2) + col / 2] |= static_cast<uint8_t>((indices[i] & 0x0F) << ((col & 1) * 4));
+    }
+    textures.push_back(makeTexture(LibTXD::RasterFormat::PAL8, LibTXD::Compression::NONE, 8, indices));
+    textures.back().setPalette(palette, 256);
+    textures.push_back(makeTexture(LibTXD::RasterFormat::PAL4, LibTXD::Compression::NONE, 4, packed));
+    textures.back().setPalette(std::vector<uint8_t>(palette.begin(), palette.begin() + 64), 16);
+    
+    const uint32_t regions[][4] = { {0, 0, width, height}, {3, 2, 9, 7}, {20, 12, 1, 1}, {5, 0, 16, 4} };
+    for (size_t t = 0; t < textures.size(); t++) {
+        auto full = LibTXD::TextureConverter::convertToRGBA8(textures[t], 0);
+        ASSERT_NE(full, nullptr);
+        for (const auto& r : regions) {
+            // Padded rows check that outputStride is honoured
+            const size_t stride = r[2] * 4 + 8;
+            std::vector<uint8_t> region(stride * r[3], 0xCD);
+            ASSERT_TRUE(LibTXD::TextureConverter::decodeRegion(textures[t], 0, r[0], r[1], r[2], r[3],
+                                                               region.data(), stride));
+            for (uint32_t row = 0; row < r[3]; row++) {
+                EXPECT_EQ(std::memcmp(region.data() + row * stride,
+                                      full.get() + ((r[1] + row) * width + r[0]) * 4, r[2] * 4), 0)
+                    << "Texture " << t << " region " << r[0] << "," << r[1] << " row " << row;
+                EXPECT_EQ(region[row * stride + r[2] * 4], 0xCD);
+            }
+        }
+    }
+    
+    std::vector<uint8_t> out(width * height * 4);
+    EXPECT_FALSE(LibTXD::TextureConverter::decodeRegion(textures[0], 0, 20, 0, 2, 1, out.data()));
+    EXPECT_FALSE(LibTXD::TextureConverter::decodeRegion(textures[0], 0, 0, 0, 0, 1, out.data()));
+    EXPECT_FALSE(LibTXD::TextureConverter::decodeRegion(textures[0], 1, 0, 0, 1, 1, out.data()));
+}
+
+TEST_F(TextureConverterTest, GenerateMipmaps_FullChainDimensions) {
+    auto rgba = createGradientRGBA(32, 8);
+    
+    auto levels = LibTXD::TextureConverter::generateMipmaps(rgba.data(), 32, 8);
+    ASSERT_EQ(levels.size(), 6u);
+    
+    const uint32_t expected[][2] = { {32, 8}, {16, 4}, {8, 2}, {4, 1}, {2, 1}, {1, 1} };
+    for (size_t i = 0; i < levels.size(); i++) {
+        EXPECT_EQ(levels[i].width, expected[i][0]) << "Level " << i;
+        EXPECT_EQ(levels[i].height, expected[i][1]) << "Level " << i;
+        EXPECT_EQ(levels[i].rgba.size(), expected[i][0] * expected[i][1] * 4) << "Level " << i;
+    }
+    EXPECT_EQ(levels[0].rgba, rgba);
+    
+    LibTXD::MipmapOptions options;
+    options.maxLevels = 2;
+    EXPECT_EQ(LibTXD::TextureConverter::generateMipmaps(rgba.data(), 32, 8, options).size(), 2u);
+}
+
+TEST_F(TextureConverterTest, DownsampleRGBA_BoxAveragesQuads) {
+    // 6x2 image: exercises the vectorised path and the scalar tail
+    std::vector<uint8_t> rgba(6 * 2 * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = static_cast<uint8_t>(i * 3);
+    }
+    
+    std::vector<uint8_t> output(3 * 1 * 4);
+    LibTXD::TextureConverter::downsampleRGBA(rgba.data(), 6, 2, LibTXD::MipmapFilter::Box, output.data());
+    
+    for (uint32_t x = 0; x < 3; x++) {
+        for (uint32_t c = 0; c < 4; c++) {
+            int sum = rgba[(2 * x) * 4 + c] + rgba[(2 * x + 1) * 4 + c] +
+                      rgba[(6 + 2 * x) * 4 + c] + rgba[(6 + 2 * x + 1) * 4 + c];
+            EXPECT_EQ(output[x * 4 + c], (sum + 2) / 4) << "Pixel " << x << " channel " << c;
+        }
+    }
+}
+
+TEST_F(TextureConverterTest, DownsampleRGBA_WindowedSincKeepsSolidColour) {
+    auto rgba = createTestRGBA(16, 16, 200, 100, 50, 255);
+    std::vector<uint8_t> output(8 * 8 * 4);
+    
+    for (auto filter : {LibTXD::MipmapFilter::Kaiser, LibTXD::MipmapFilter::Lanczos}) {
+        LibTXD::TextureConverter::downsampleRGBA(rgba.data(), 16, 16, filter, output.data());
+        for (size_t i = 0; i < 8 * 8; i++) {
+            EXPECT_EQ(output[i * 4 + 0], 200);
+            EXPECT_EQ(output[i * 4 + 1], 100);
+            EXPECT_EQ(output[i * 4 + 2], 50);
+            EXPECT_EQ(output[i * 4 + 3], 255);
+        }
+    }
+}
+
+TEST_F(TextureConverterTest, DownsampleRGBA_GammaCorrectCheckerboard) {
+    // Black/white checkerboard averages to 50% linear light, which is sRGB 188
+    std::vector<uint8_t> rgba(8 * 8 * 4);
+    for (uint32_t y = 0; y < 8; y++) {
+        for (uint32_t x = 0; x < 8; x++) {
+            uint8_t value = ((x + y) & 1) ? 255 : 0;
+            uint8_t* px = &rgba[(y * 8 + x) * 4];
+            px[0] = px[1] = px[2] = value;
+            px[3] = value;
+        }
+    }
+    
+    std::vector<uint8_t> output(4 * 4 * 4);
+    LibTXD::TextureConverter::downsampleRGBA(rgba.data(), 8, 8, LibTXD::MipmapFilter::Box, output.data(), true);
+    for (size_t i = 0; i < 4 * 4; i++) {
+        EXPECT_NEAR(output[i * 4 + 0], 188, 1);
+        EXPECT_NEAR(output[i * 4 + 2], 188, 1);
+        // Alpha is not gamma encoded
+        EXPECT_EQ(output[i * 4 + 3], 128);
+    }
+    
+    // The windowed sinc filters get the same brightening relative to sRGB-space filtering
+    std::vector<uint8_t> naive(4 * 4 * 4);
+    LibTXD::TextureConverter::downsampleRGBA(rgba.data(), 8, 8, LibTXD::MipmapFilter::Kaiser, naive.data());
+    LibTXD::TextureConverter::downsampleRGBA(rgba.data(), 8, 8, LibTXD::MipmapFilter::Kaiser, output.data(), true);
+    for (size_t i = 0; i < 4 * 4; i++) {
+        EXPECT_GT(output[i * 4 + 1], naive[i * 4 + 1] + 40);
+        EXPECT_EQ(output[i * 4 + 3], naive[i * 4 + 3]);
+    }
+}
+
+TEST_F(TextureConverterTest, DownsampleRGBA_GammaCorrectKeepsSolidColours) {
+    // Every sRGB value must survive the linear round trip unchanged
+    std::vector<uint8_t> rgba(256 * 2 * 4);
+    for (uint32_t x = 0; x < 256; x++) {
+        for (uint32_t y = 0; y < 2; y++) {
+            uint8_t* px = &rgba[(y * 256 + x) * 4];
+            px[0] = px[1] = px[2] = px[3] = static_cast<uint8_t>(x);
+        }
+    }
+    // Duplicate each column so every 2x2 quad is a single colour
+    std::vector<uint8_t> wide(512 * 2 * 4);
+    for (uint32_t y = 0; y < 2; y++) {
+        for (uint32_t x = 0; x < 512; x++) {
+            std::memcpy(&wide[(y * 512 + x) * 4], &rgba[(y * 256 + x / 2) * 4], 4);
+        }
+    }
+    
+    std::vector<uint8_t> output(256 * 4);
+    LibTXD::TextureConverter::downsampleRGBA(wide.data(), 512, 2, LibTXD::MipmapFilter::Box, output.data(), true);
+    for (uint32_t x = 0; x < 256; x++) {
+        EXPECT_EQ(output[x * 4 + 0], x);
+        EXPECT_EQ(output[x * 4 + 3], x);
+    }
+    
+    auto solid = createTestRGBA(16, 16, 200, 100, 50, 255);
+    LibTXD::MipmapOptions options;
+    options.filter = LibTXD::MipmapFilter::Lanczos;
+    options.gammaCorrect = true;
+    auto levels = LibTXD::TextureConverter::generateMipmaps(solid.data(), 16, 16, options);
+    ASSERT_EQ(levels.size(), 5u);
+    EXPECT_EQ(levels[4].rgba[0], 200);
+    EXPECT_EQ(levels[4].rgba[1], 100);
+    EXPECT_EQ(levels[4].rgba[2], 50);
+}
+
+TEST_F(TextureConverterTest, ResizeRGBA_EveryFilterKeepsSolidColour) {
+    auto rgba = createTestRGBA(37, 23, 200, 100, 50, 128);
+    const uint32_t sizes[][2] = {{16, 16}, {64, 41}, {5, 90}, {1, 1}};
+    for (auto filter : {LibTXD::ResizeFilter::Box, LibTXD::ResizeFilter::Bilinear,
+                        LibTXD::ResizeFilter::Bicubic, LibTXD::ResizeFilter::Lanczos3}) {
+        for (const auto& size : sizes) {
+            for (bool gammaCorrect : {false, true}) {
+                std::vector<uint8_t> output(static_cast<size_t>(size[0]) * size[1] * 4);
+                ASSERT_TRUE(LibTXD::TextureConverter::resizeRGBA(rgba.data(), 37, 23, output.data(),
+                                                                 size[0], size[1], filter, gammaCorrect));
+                for (size_t i = 0; i < output.size() / 4; i++) {
+                    ASSERT_EQ(output[i * 4 + 0], 200);
+                    ASSERT_EQ(output[i * 4 + 1], 100);
+                    ASSERT_EQ(output[i * 4 + 2], 50);
+                    ASSERT_EQ(output[i * 4 + 3], 128);
+                }
+            }
+        }
+    }
+    
+    std::vector<uint8_t> output(4);
+    EXPECT_FALSE(LibTXD::TextureConverter::resizeRGBA(nullptr, 4, 4, output.data(), 1, 1));
+    EXPECT_FALSE(LibTXD::TextureConverter::resizeRGBA(rgba.data(), 37, 23, output.data(), 0, 1));
+}
+
+TEST_F(TextureConverterTest, ResizeRGBA_FiltersFollowTheRamp) {
+    // Two-pixel ramp enlarged to eight: bilinear interpolates, box repeats
+    std::vector<uint8_t> rgba = {0, 0, 0, 255, 240, 240, 240, 255};
+    std::vector<uint8_t> output(8 * 4);
+    
+    ASSERT_TRUE(LibTXD::TextureConverter::resizeRGBA(rgba.data(), 2, 1, output.data(), 8, 1,
+                                                     LibTXD::ResizeFilter::Bilinear));
+    const int bilinear[8] = {0, 0, 30, 90, 150, 210, 240, 240};
+    for (int x = 0; x < 8; x++) {
+        EXPECT_NEAR(output[x * 4], bilinear[x], 1) << "x=" << x;
+    }
+    
+    ASSERT_TRUE(LibTXD::TextureConverter::resizeRGBA(rgba.data(), 2, 1, output.data(), 8, 1,
+                                                     LibTXD::ResizeFilter::Box));
+    for (int x = 0; x < 8; x++) {
+        EXPECT_EQ(output[x * 4], x < 4 ? 0 : 240);
+    }
+    
+    // A 3:1 box reduction is the average of each triple
+    std::vector<uint8_t> row(6 * 4, 255);
+    const uint8_t values[6] = {0, 30, 60, 90, 120, 150};
+    for (int x = 0; x < 6; x++) {
+        row[x * 4] = values[x];
+    }
+    ASSERT_TRUE(LibTXD::TextureConverter::resizeRGBA(row.data(), 6, 1, output.data(), 2, 1,
+                                                     LibTXD::ResizeFilter::Box));
+    EXPECT_EQ(output[0], 30);
+    EXPECT_EQ(output[4], 120);
+}
+
+TEST_F(TextureConverterTest, ResizeRGBA_TransparentColourDoesNotBleed) {
+    // Left half transparent red, right half opaque green
+    std::vector<uint8_t> rgba(16 * 4 * 4);
+    for (uint32_t y = 0; y < 4; y++) {
+        for (uint32_t x = 0; x < 16; x++) {
+            uint8_t* p = rgba.data() + (y * 16 + x) * 4;
+            p[0] = x < 8 ? 255 : 0;
+            p[1] = x < 8 ? 0 : 255;
+            p[2] = 0;
+            p[3] = x < 8 ? 0 : 255;
+        }
+    }
+    
+    for (auto filter : {LibTXD::ResizeFilter::Box, LibTXD::ResizeFilter::Bilinear,
+                        LibTXD::ResizeFilter::Lanczos3}) {
+        for (bool gammaCorrect : {false, true}) {
+            for (uint32_t outWidth : {8u, 5u, 24u}) {
+                std::vector<uint8_t> output(static_cast<size_t>(outWidth) * 2 * 4);
+                ASSERT_TRUE(LibTXD::TextureConverter::resizeRGBA(rgba.data(), 16, 4, output.data(), outWidth, 2,
+                                                                 filter, gammaCorrect));
+                bool sawEdge = false;
+                for (size_t i = 0; i < output.size() / 4; i++) {
+                    if (output[i * 4 + 3] > 0) {
+                        EXPECT_EQ(output[i * 4 + 0], 0) << "pixel " << i << " outWidth " << outWidth;
+                        sawEdge = sawEdge || output[i * 4 + 3] < 255;
+                    }
+                }
+                if (filter != LibTXD::ResizeFilter::Box) {
+                    EXPECT_TRUE(sawEdge);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(TextureConverterTest, GetResizeDimensions_PowerOfTwoRounding) {
+    using LibTXD::PowerOfTwoRounding;
+    EXPECT_EQ(LibTXD::TextureConverter::roundToPowerOfTwo(300, PowerOfTwoRounding::Nearest), 256u);
+    EXPECT_EQ(LibTXD::TextureConverter::roundToPowerOfTwo(400, PowerOfTwoRounding::Nearest), 512u);
+    EXPECT_EQ(LibTXD::TextureConverter::roundToPowerOfTwo(300, PowerOfTwoRounding::Up), 512u);
+    EXPECT_EQ(LibTXD::TextureConverter::roundToPowerOfTwo(300, PowerOfTwoRounding::Down), 256u);
+    EXPECT_EQ(LibTXD::TextureConverter::roundToPowerOfTwo(256, PowerOfTwoRounding::Up), 256u);
+    EXPECT_EQ(LibTXD::TextureConverter::roundToPowerOfTwo(300, PowerOfTwoRounding::None), 300u);
+    
+    uint32_t width, height;
+    LibTXD::TextureConverter::getResizeDimensions(2048, 1000, 1024, PowerOfTwoRounding::Nearest, width, height);
+    EXPECT_EQ(width, 1024u);
+    EXPECT_EQ(height, 512u);
+    LibTXD::TextureConverter::getResizeDimensions(2048, 1000, 1024, PowerOfTwoRounding::None, width, height);
+    EXPECT_EQ(width, 1024u);
+    EXPECT_EQ(height, 500u);
+    LibTXD::TextureConverter::getResizeDimensions(900, 100, 1024, PowerOfTwoRounding::Up, width, height);
+    EXPECT_EQ(width, 1024u);
+    EXPECT_EQ(height, 128u);
+    LibTXD::TextureConverter::getResizeDimensions(1000, 100, 768, PowerOfTwoRounding::Up, width, height);
+    EXPECT_EQ(width, 512u);
+    EXPECT_EQ(height, 128u);
+}
+
+TEST_F(TextureConverterTest, GenerateMipmaps_PreservesAlphaCoverage) {
+    // Noisy alpha-tested foliage: averaging pulls alpha towards the mean and
+    // makes most pixels fail the test on smaller levels
+    std::vector<uint8_t> rgba(64 * 64 * 4, 255);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < 64 * 64; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        rgba[i * 4 + 3] = static_cast<uint8_t>(seed >> 24);
+    }
+    
+    float baseCoverage = LibTXD::TextureConverter::computeAlphaCoverage(rgba.data(), 64, 64, 192);
+    EXPECT_GT(baseCoverage, 0.15f);
+    
+    auto plain = LibTXD::TextureConverter::generateMipmaps(rgba.data(), 64, 64);
+    EXPECT_LT(LibTXD::TextureConverter::computeAlphaCoverage(plain[2].rgba.data(), 16, 16, 192), 0.05f);
+    
+    LibTXD::MipmapOptions options;
+    options.preserveAlphaCoverage = true;
+    options.alphaReference = 192;
+    auto levels = LibTXD::TextureConverter::generateMipmaps(rgba.data(), 64, 64, options);
+    ASSERT_GT(levels.size(), 3u);
+    
+    for (size_t i = 1; i < 4; i++) {
+        float coverage = LibTXD::TextureConverter::computeAlphaCoverage(
+            levels[i].rgba.data(), levels[i].width, levels[i].height, 192);
+        EXPECT_NEAR(coverage, baseCoverage, 0.05f) << "Level " << i;
+    }
+}
+
+TEST_F(TextureConverterTest, PremultiplyAlpha_RoundTrips) {
+    // 23 pixels: vectorised groups of four plus a scalar tail
+    const size_t pixelCount = 23;
+    std::vector<uint8_t> rgba(pixelCount * 4);
+    for (size_t i = 0; i < pixelCount; i++) {
+        rgba[i * 4 + 0] = static_cast<uint8_t>(i * 11);
+        rgba[i * 4 + 1] = static_cast<uint8_t>(255 - i * 5);
+        rgba[i * 4 + 2] = static_cast<uint8_t>(i * 37);
+        rgba[i * 4 + 3] = static_cast<uint8_t>(i == 0 ? 0 : (i == 1 ? 255 : 20 + i * 10));
+    }
+    
+    auto premultiplied = rgba;
+    LibTXD::TextureConverter::premultiplyAlpha(premultiplied.data(), pixelCount);
+    for (size_t i = 0; i < pixelCount * 4; i++) {
+        uint32_t a = rgba[(i / 4) * 4 + 3];
+        uint32_t expected = i % 4 == 3 ? a : (rgba[i] * a * 2 + 255) / 510;
+        EXPECT_EQ(premultiplied[i], expected) << "Byte " << i;
+    }
+    
+    auto restored = premultiplied;
+    LibTXD::TextureConverter::unpremultiplyAlpha(restored.data(), pixelCount);
+    for (size_t i = 1; i < pixelCount; i++) {
+        int a = rgba[i * 4 + 3];
+        EXPECT_EQ(restored[i * 4 + 3], a);
+        for (int c = 0; c < 3; c++) {
+            // Premultiplying rounds away log2(255 / alpha) bits
+            EXPECT_LE(std::abs(restored[i * 4 + c] - rgba[i * 4 + c]), 255 / (2 * a) + 1) << "Pixel " << i;
+        }
+    }
+    EXPECT_EQ(std::memcmp(restored.data(), premultiplied.data(), 4), 0);
+}
+
+TEST_F(TextureConverterTest, BleedAlpha_FillsTransparentPixels) {
+    // Visible red on the left, transparent noise on the right
+    auto rgba = createTestRGBA(8, 8, 200, 0, 0, 255);
+    for (uint32_t y = 0; y < 8; y++) {
+        for (uint32_t x = 4; x < 8; x++) {
+            uint8_t* p = &rgba[(y * 8 + x) * 4];
+            p[0] = static_cast<uint8_t>(x * 30);
+            p[1] = static_cast<uint8_t>(y * 30);
+            p[2] = 255;
+            p[3] = 0;
+        }
+    }
+    
+    auto bled = rgba;
+    LibTXD::TextureConverter::bleedAlpha(bled.data(), 8, 8);
+    for (size_t i = 0; i < 64; i++) {
+        EXPECT_EQ(bled[i * 4 + 0], 200);
+        EXPECT_EQ(bled[i * 4 + 1], 0);
+        EXPECT_EQ(bled[i * 4 + 2], 0);
+        EXPECT_EQ(bled[i * 4 + 3], rgba[i * 4 + 3]);
+    }
+    
+    // Nothing visible to bleed from
+    auto empty = createTestRGBA(4, 4, 1, 2, 3, 0);
+    auto unchanged = empty;
+    LibTXD::TextureConverter::bleedAlpha(unchanged.data(), 4, 4);
+    EXPECT_EQ(unchanged, empty);
+    
+    // Selected as a preprocessing step, compression sees the bled image;
+    // bands of compressBatch must agree with the whole-image result
+    LibTXD::CompressionProfile profile;
+    profile.alphaPreprocess = LibTXD::AlphaPreprocess::Bleed;
+    auto direct = LibTXD::TextureConverter::compressToDXT(rgba.data(), 8, 8, LibTXD::Compression::DXT5, profile);
+    auto expected = LibTXD::TextureConverter::compressToDXT(bled.data(), 8, 8, LibTXD::Compression::DXT5);
+    ASSERT_NE(direct, nullptr);
+    ASSERT_NE(expected, nullptr);
+    EXPECT_EQ(std::memcmp(direct.get(), expected.get(), 64), 0);
+    
+    std::vector<uint8_t> tall(8 * 80 * 4);
+    for (size_t i = 0; i < 8 * 80; i++) {
+        std::memcpy(&tall[i * 4], &rgba[(i % 64) * 4], 4);
+    }
+    tall[79 * 8 * 4 + 3] = 255;
+    auto batch = LibTXD::TextureConverter::compressBatch({ { tall.data(), 8, 80, LibTXD::Compression::DXT5, profile } });
+    auto whole = LibTXD::TextureConverter::compressToDXT(tall.data(), 8, 80, LibTXD::Compression::DXT5, profile);
+    ASSERT_EQ(batch.size(), 1u);
+    ASSERT_NE(whole, nullptr);
+    ASSERT_EQ(batch[0].size(), 640u);
+    EXPECT_EQ(std::memcmp(batch[0].data(), whole.get(), 640), 0);
+}
+
+TEST_F(TextureConverterTest, GenerateMipmaps_AlphaPreprocessing) {
+    // Half-transparent blue over stray green
+    auto rgba = createTestRGBA(16, 16, 0, 255, 0, 0);
+    for (size_t i = 0; i < 16 * 8; i++) {
+        rgba[i * 4 + 1] = 0;
+        rgba[i * 4 + 2] = 255;
+        rgba[i * 4 + 3] = 128;
+    }
+    
+    LibTXD::MipmapOptions options;
+    options.alphaPreprocess = LibTXD::AlphaPreprocess::Bleed;
+    auto bled = LibTXD::TextureConverter::generateMipmaps(rgba.data(), 16, 16, options);
+    ASSERT_EQ(bled.size(), 5u);
+    for (const auto& level : bled) {
+        for (size_t i = 0; i < level.rgba.size(); i += 4) {
+            EXPECT_EQ(level.rgba[i + 1], 0) << level.width << "x" << level.height;
+        }
+    }
+    
+    options.alphaPreprocess = LibTXD::AlphaPreprocess::Premultiply;
+    auto premultiplied = LibTXD::TextureConverter::generateMipmaps(rgba.data(), 16, 16, options);
+    ASSERT_EQ(premultiplied.size(), 5u);
+    const auto& last = premultiplied.back().rgba;
+    EXPECT_EQ(last[1], 0);
+    EXPECT_EQ(last[3], 64);
+    EXPECT_NEAR(last[2], 64, 1);
+}
+
 // ============================================================================
 // Integration Tests
 // ============================================================================
@@ -905,6 +2568,147 @@ protected:
     }
 };
 
+TEST_F(IntegrationTest, CompressionCache_StoreLoadAndKeyMismatch) {
+    LibTXD::CompressionCache cache((tempDir / "cache").string());
+    
+    LibTXD::CacheKey key;
+    key.pixelHash = 0x1234;
+    key.width = 8;
+    key.height = 4;
+    key.format = 1;
+    key.settings = 99;
+    
+    std::vector<uint8_t> payload = { 1, 2, 3, 4, 5 };
+    ASSERT_TRUE(cache.store(key, payload.data(), payload.size()));
+    
+    std::vector<uint8_t> loaded;
+    ASSERT_TRUE(cache.load(key, loaded));
+    EXPECT_EQ(loaded, payload);
+    
+    LibTXD::CacheKey other = key;
+    other.settings = 100;
+    EXPECT_FALSE(cache.load(other, loaded));
+    EXPECT_EQ(cache.getHitCount(), 1u);
+    EXPECT_EQ(cache.getMissCount(), 1u);
+    
+    cache.clear();
+    EXPECT_FALSE(cache.load(key, loaded));
+}
+
+TEST_F(IntegrationTest, CompressionCache_RejectsCorruptPayloadSize) {
+    const std::filesystem::path directory = tempDir / "cache";
+    LibTXD::CompressionCache cache(directory.string());
+    
+    LibTXD::CacheKey key;
+    key.pixelHash = 0x5678;
+    key.width = 4;
+    key.height = 4;
+    std::vector<uint8_t> payload(8, 0x5A);
+    ASSERT_TRUE(cache.store(key, payload.data(), payload.size()));
+    
+    std::filesystem::path entryPath;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        entryPath = entry.path();
+    }
+    ASSERT_FALSE(entryPath.empty());
+    
+    // Claim an enormous payload: the entry must be rejected without allocating it
+    {
+        std::fstream file(entryPath, std::ios::binary | std::ios::in | std::ios::out);
+        ASSERT_TRUE(file.is_open());
+        file.seekp(36);
+        const uint64_t hugeSize = 0xFFFFFFFFFFFFull;
+        file.write(reinterpret_cast<const char*>(&hugeSize), sizeof(hugeSize));
+    }
+    std::vector<uint8_t> loaded;
+    EXPECT_FALSE(cache.load(key, loaded));
+    EXPECT_TRUE(loaded.empty());
+    EXPECT_EQ(cache.getMissCount(), 1u);
+    
+    // A truncated payload is rejected too
+    ASSERT_TRUE(cache.store(key, payload.data(), payload.size()));
+    std::filesystem::resize_file(entryPath, std::filesystem::file_size(entryPath) - 3);
+    EXPECT_FALSE(cache.load(key, loaded));
+    EXPECT_EQ(cache.getMissCount(), 2u);
+    EXPECT_EQ(cache.getHitCount(), 0u);
+}
+
+TEST_F(IntegrationTest, CompressionCache_PrunesLeastRecentlyUsed) {
+    const std::string directory = (tempDir / "cache").string();
+    LibTXD::CompressionCache cache(directory, 3500);
+    EXPECT_EQ(cache.getMaxBytes(), 3500u);
+    
+    std::vector<LibTXD::CacheKey> keys(4);
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i].pixelHash = 0x100 + i;
+        keys[i].width = 32;
+        keys[i].height = 32;
+    }
+    std::vector<uint8_t> payload(1000, 0xAB);
+    std::vector<uint8_t> loaded;
+    
+    for (size_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(cache.store(keys[i], payload.data(), payload.size()));
+    }
+    EXPECT_GT(cache.getTotalBytes(), 3000u);
+    EXPECT_LE(cache.getTotalBytes(), 3500u);
+    
+    // Using the oldest entry makes the next two the pruning candidates
+    ASSERT_TRUE(cache.load(keys[0], loaded));
+    ASSERT_TRUE(cache.store(keys[3], payload.data(), payload.size()));
+    EXPECT_LE(cache.getTotalBytes(), 3500u);
+    EXPECT_TRUE(cache.load(keys[0], loaded));
+    EXPECT_FALSE(cache.load(keys[1], loaded));
+    EXPECT_TRUE(cache.load(keys[3], loaded));
+    
+    // A new instance measures the directory and trims it to its own limit
+    LibTXD::CompressionCache smaller(directory, 1500);
+    EXPECT_LE(smaller.getTotalBytes(), 1500u);
+    EXPECT_TRUE(smaller.load(keys[3], loaded));
+    EXPECT_FALSE(smaller.load(keys[0], loaded));
+}
+
+TEST_F(IntegrationTest, CompressionCache_ServesRepeatedEncodes) {
+    auto cache = std::make_shared<LibTXD::CompressionCache>((tempDir / "cache").string());
+    LibTXD::TextureConverter::setCompressionCache(cache);
+    
+    std::vector<uint8_t> rgba(16 * 16 * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = static_cast<uint8_t>(i * 7);
+    }
+    
+    size_t size = LibTXD::TextureConverter::getCompressedDataSize(16, 16, LibTXD::Compression::DXT3);
+    auto first = LibTXD::TextureConverter::compressToDXT(rgba.data(), 16, 16, LibTXD::Compression::DXT3);
+    auto second = LibTXD::TextureConverter::compressToDXT(rgba.data(), 16, 16, LibTXD::Compression::DXT3);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(std::memcmp(first.get(), second.get(), size), 0);
+    EXPECT_EQ(cache->getHitCount(), 1u);
+    
+    // A different profile is a different entry
+    LibTXD::TextureConverter::compressToDXT(rgba.data(), 16, 16, LibTXD::Compression::DXT3,
+                                            LibTXD::CompressionProfile::rangeFit());
+    EXPECT_EQ(cache->getHitCount(), 1u);
+    
+    // Batches share entries with single compressions
+    std::vector<LibTXD::CompressionJob> jobs = {
+        { rgba.data(), 16, 16, LibTXD::Compression::DXT3, LibTXD::CompressionProfile() }
+    };
+    auto batch = LibTXD::TextureConverter::compressBatch(jobs);
+    ASSERT_EQ(batch[0].size(), size);
+    EXPECT_EQ(std::memcmp(batch[0].data(), first.get(), size), 0);
+    EXPECT_EQ(cache->getHitCount(), 2u);
+    
+    std::vector<uint8_t> palette, indices, cachedPalette, cachedIndices;
+    ASSERT_TRUE(LibTXD::TextureConverter::generatePalette(rgba.data(), 16, 16, 256, palette, indices));
+    ASSERT_TRUE(LibTXD::TextureConverter::generatePalette(rgba.data(), 16, 16, 256, cachedPalette, cachedIndices));
+    EXPECT_EQ(cachedPalette, palette);
+    EXPECT_EQ(cachedIndices, indices);
+    EXPECT_EQ(cache->getHitCount(), 3u);
+    
+    LibTXD::TextureConverter::setCompressionCache(nullptr);
+}
+
 TEST_F(IntegrationTest, CreateNewTXD_AddTextures_Save_Reload) {
     // Create a new TXD from scratch
     LibTXD::TextureDictionary dict;
@@ -928,11 +2732,12 @@ TEST_F(IntegrationTest, CreateNewTXD_AddTextures_Save_Reload) {
     mip.data.resize(mip.dataSize);
     
     // Fill with a pattern
+    uint8_t* pixels = mip.data.mutableData();
     for (size_t i = 0; i < mip.dataSize; i += 4) {
-        mip.data[i + 0] = 0;    // B
-        mip.data[i + 1] = 128;  // G
-        mip.data[i + 2] = 255;  // R
-        mip.data[i + 3] = 255;  // A
+        pixels[i + 0] = 0;    // B
+        pixels[i + 1] = 128;  // G
+        pixels[i + 2] = 255;  // R
+        pixels[i + 3] = 255;  // A
     }
     
     texture.addMipmap(std::move(mip));
@@ -1049,7 +2854,7 @@ TEST_F(IntegrationTest, CompressedTexture_FullPipeline) {
     
     // Compress to DXT1
     auto compressed = LibTXD::TextureConverter::compressToDXT(
-        rgbaData.data(), width, height, LibTXD::Compression::DXT1, 1.0f);
+        rgbaData.data(), width, height, LibTXD::Compression::DXT1);
     ASSERT_NE(compressed, nullptr);
     
     size_t compressedSize = LibTXD::TextureConverter::getCompressedDataSize(
@@ -1098,6 +2903,103 @@ TEST_F(IntegrationTest, CompressedTexture_FullPipeline) {
     EXPECT_TRUE(hasColorData);
 }
 
+TEST_F(IntegrationTest, DXT5Texture_D3D9_Save_Reload) {
+    LibTXD::TextureDictionary dict;
+    dict.setVersion(0x1803FFFF);
+    
+    std::vector<uint8_t> rgba(32 * 32 * 4);
+    for (size_t i = 0; i < 32 * 32; i++) {
+        rgba[i * 4 + 0] = static_cast<uint8_t>(i);
+        rgba[i * 4 + 1] = 90;
+        rgba[i * 4 + 2] = 200;
+        rgba[i * 4 + 3] = static_cast<uint8_t>((i % 32) * 8);
+    }
+    auto compressed = LibTXD::TextureConverter::compressToDXT(rgba.data(), 32, 32, LibTXD::Compression::DXT5);
+    ASSERT_NE(compressed, nullptr);
+    size_t size = LibTXD::TextureConverter::getCompressedDataSize(32, 32, LibTXD::Compression::DXT5);
+    
+    LibTXD::Texture texture;
+    texture.setName("smoke");
+    texture.setPlatform(LibTXD::Platform::D3D9);
+    texture.setRasterFormat(LibTXD::RasterFormat::B8G8R8A8);
+    texture.setDepth(16);
+    texture.setHasAlpha(true);
+    texture.setCompression(LibTXD::Compression::DXT5);
+    LibTXD::MipmapLevel mip;
+    mip.width = 32;
+    mip.height = 32;
+    mip.data.assign(compressed.get(), compressed.get() + size);
+    mip.dataSize = size;
+    texture.addMipmap(std::move(mip));
+    dict.addTexture(std::move(texture));
+    
+    fs::path savePath = tempDir / "dxt5.txd";
+    ASSERT_TRUE(dict.save(savePath.string()));
+    LibTXD::TextureDictionary reloaded;
+    ASSERT_TRUE(reloaded.load(savePath.string()));
+    
+    const auto* tex = reloaded.getTexture(0);
+    ASSERT_NE(tex, nullptr);
+    EXPECT_EQ(tex->getCompression(), LibTXD::Compression::DXT5);
+    EXPECT_TRUE(tex->hasAlpha());
+    EXPECT_TRUE(LibTXD::TextureConverter::canConvert(*tex));
+    
+    auto decoded = LibTXD::TextureConverter::convertToRGBA8(*tex, 0);
+    auto expected = LibTXD::TextureConverter::decompressDXT(compressed.get(), 32, 32, LibTXD::Compression::DXT5);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_EQ(std::memcmp(decoded.get(), expected.get(), 32 * 32 * 4), 0);
+}
+
+TEST_F(IntegrationTest, CompressedMipChain_Save_Reload) {
+    const uint32_t width = 16;
+    const uint32_t height = 8;
+    std::vector<uint8_t> rgbaData(width * height * 4, 255);
+    
+    auto levels = LibTXD::TextureConverter::generateMipmaps(rgbaData.data(), width, height);
+    ASSERT_EQ(levels.size(), 5u);
+    
+    LibTXD::Texture texture;
+    texture.setName("mipped");
+    texture.setPlatform(LibTXD::Platform::D3D9);
+    texture.setRasterFormat(static_cast<LibTXD::RasterFormat>(
+        static_cast<uint32_t>(LibTXD::RasterFormat::B8G8R8) | static_cast<uint32_t>(LibTXD::RasterFormat::MIPMAP)));
+    texture.setDepth(16);
+    texture.setCompression(LibTXD::Compression::DXT1);
+    
+    for (size_t level = 0; level < levels.size(); level++) {
+        auto compressed = LibTXD::TextureConverter::compressToDXT(
+            levels[level].rgba.data(), levels[level].width, levels[level].height, LibTXD::Compression::DXT1);
+        ASSERT_NE(compressed, nullptr);
+        
+        LibTXD::MipmapLevel mip;
+        LibTXD::Texture::getMipmapDimensions(width, height, static_cast<uint32_t>(level),
+                                             LibTXD::Compression::DXT1, mip.width, mip.height);
+        mip.dataSize = static_cast<uint32_t>(LibTXD::TextureConverter::getCompressedDataSize(
+            levels[level].width, levels[level].height, LibTXD::Compression::DXT1));
+        mip.data.assign(compressed.get(), compressed.get() + mip.dataSize);
+        texture.addMipmap(std::move(mip));
+    }
+    
+    LibTXD::TextureDictionary dict;
+    dict.addTexture(std::move(texture));
+    fs::path savePath = tempDir / "mipchain.txd";
+    ASSERT_TRUE(dict.save(savePath.string()));
+    
+    LibTXD::TextureDictionary reloaded;
+    ASSERT_TRUE(reloaded.load(savePath.string()));
+    const auto* tex = reloaded.getTexture(0);
+    ASSERT_NE(tex, nullptr);
+    ASSERT_EQ(tex->getMipmapCount(), 5u);
+    
+    const uint32_t expected[][2] = { {16, 8}, {8, 4}, {4, 4}, {4, 4}, {4, 4} };
+    for (uint32_t level = 0; level < 5; level++) {
+        EXPECT_EQ(tex->getMipmap(level).width, expected[level][0]) << "Level " << level;
+        EXPECT_EQ(tex->getMipmap(level).height, expected[level][1]) << "Level " << level;
+        EXPECT_EQ(tex->getMipmap(level).dataSize, 8u * std::max(1u, expected[level][0] / 4) * std::max(1u, expected[level][1] / 4) ) << "Level " << level;
+        EXPECT_NE(LibTXD::TextureConverter::convertToRGBA8(*tex, level), nullptr);
+    }
+}
+
 // ============================================================================
 // Game-Specific Tests
 // ============================================================================